@@ -0,0 +1,325 @@
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include "node.hpp"
+using namespace std;
+/**
+ * @brief HEAP IMPLEMENTATION
+ *
+ * This implementation is a hibrid, because we use an array to save data, but,
+ * access, and writting is using binary tree operations
+ *
+ * Besides the heap array it keeps a position index: position[ID - 1] is the
+ * slot of the heap where the node with that ID is stored. Every swap updates
+ * it, so looking a node up by its ID is O(1) instead of a search of the tree.
+ */
+class MinHeap{
+    Node **heap_array; // pointer to array of elements in heap
+    int *position; // position[ID - 1] = slot of that node in heap_array, -1 if absent
+    int capacity; // maximum possible size of min heap
+    int heap_size; // Current number of elements in min heap
+
+public:
+    // Constructor: Initialise a capacity and heap_array;
+    MinHeap(int capacity){
+        this->heap_size = 0;
+        this->capacity = capacity;
+        this->heap_array = (Node **)malloc(sizeof(Node *) * capacity);
+        this->position = (int *)malloc(sizeof(int) * capacity);
+        for(int i = 0; i < capacity; i++)
+            position[i] = -1;
+    }
+
+    //Since we use malloc, it´s needed to clean memory manually
+    ~MinHeap(){
+        free(heap_array);
+        free(position);
+    }
+
+    // method to heapify a subtree with the root at given index i
+    void MinHeapify(int i){
+        /* A recursive method to heapify 'heap_array' */
+        int l = left(i);
+        int r = right(i);
+
+        int smallest = i;
+        if (l < heap_size && heap_array[l]->get_ID() < heap_array[i]->get_ID())
+            smallest = l;
+        if (r < heap_size && heap_array[r]->get_ID() < heap_array[smallest]->get_ID())
+            smallest = r;
+
+        if (smallest != i){
+            swap_slots(i, smallest);
+            MinHeapify(smallest);
+        }
+    }
+
+    // method to get index of parent of node at index i
+    int parent(int i){ return (i-1)/2; }
+
+    // method to get index of left child of node at index i
+    int left(int i){ return (2*i + 1); }
+
+    // method to get index of right child of node at index i
+    int right(int i){ return (2*i + 2); }
+
+    int size(){ return heap_size; }
+
+    // Node stored at a slot of the heap array, slots 0 ... size()-1 cover every node
+    Node* at(int slot){ return heap_array[slot]; }
+
+    /**
+     * @brief Insert a node into heap
+     *
+     * @param k Node to insert
+     */
+    void insert(Node* k){
+
+        if (heap_size == capacity){
+            throw runtime_error("Heap overflow: could not insert a node");
+        }
+
+        // Inserting the new key at the end
+        int i = heap_size;
+        heap_array[heap_size++] = k;
+        track(i);
+
+        while (i != 0 && heap_array[parent(i)]->get_ID() > heap_array[i]->get_ID()){
+            swap_slots(i, parent(i));
+            i = parent(i);
+        }
+    }
+
+    /**
+     * @brief Builds the heap from a whole list of nodes at once
+     *
+     * Copies the list and sifts down every internal slot from the last one to
+     * the root (Floyd's heapify), that is O(n) while n calls to insert() are
+     * O(n log n) in the worst case.
+     *
+     * @param nodes List of nodes, in any order
+     * @param n Number of nodes in the list
+     */
+    void build(Node** nodes, int n){
+
+        if (n > capacity){
+            throw runtime_error("Heap overflow: could not build the heap");
+        }
+
+        heap_size = n;
+        for(int i = 0; i < n; i++){
+            heap_array[i] = nodes[i];
+            track(i);
+        }
+
+        for(int i = n/2 - 1; i >= 0; i--)
+            MinHeapify(i);
+    }
+
+    /**
+     * @brief Get the Node By Id
+     *
+     * @param id Position of the node to find, that is its ID - 1
+     * @return found Node*, NULL if it is not in the heap
+     */
+    Node* getNodeById(int id){
+
+        int found = -1;
+
+        if(id >= 0 && id < capacity)
+            found = position[id];
+
+        // IDs outside of the index range are searched through the tree
+        if(found == -1)
+            found = findFrom(0, id + 1);
+
+        return found == -1 ? NULL : heap_array[found];
+
+    }
+
+private:
+    /**
+     * @brief Records in the position index the node currently at slot i
+     */
+    void track(int i){
+        int key = heap_array[i]->get_ID() - 1;
+        if(key >= 0 && key < capacity)
+            position[key] = i;
+    }
+
+    void swap_slots(int i, int j){
+        swap(heap_array[i], heap_array[j]);
+        track(i);
+        track(j);
+    }
+
+    /**
+     * @brief Find a node by its id, in the node heap
+     *
+     * Ask if the current i, is not out of bounds
+     *
+     * Since every parent has a smaller ID than its children, once the ID at
+     * slot i is greater than the wanted one the whole subtree can be skipped.
+     *
+     * Then look a left children of node in heap, and right children, this will generate that the
+     * search starts scrolling through the tree until finding a node that returns a value other than -1
+     *
+     * @param i index to start search
+     * @param find ID to find
+     *
+     * @return position found, -1 if not found
+     */
+    int findFrom(int i, int find){
+
+        if(i > heap_size-1){
+            return -1;
+        }
+
+        int current = heap_array[i]->get_ID();
+
+        if(current == find){
+            return i;
+        }
+
+        if(current > find){
+            return -1;
+        }
+
+        int L = findFrom(left(i), find);
+        if(L != -1){
+            return L;
+        }
+
+        return findFrom(right(i), find);
+    }
+}
+
+;
+
+/**
+ * @brief INDEXED PRIORITY QUEUE
+ *
+ * Min heap of integer items 0 ... capacity-1 ordered by a key that can change
+ * while the item is queued. It uses the same position index as MinHeap,
+ * position[item] is the slot of the item, so the item can be found and moved
+ * up the tree in O(log n) when its key decreases.
+ *
+ * Used by the Sloan node ordering (see mef_utilities/sloan.hpp), whose node
+ * priorities only grow, stored here as negative keys.
+ */
+class IndexedMinHeap{
+    int *heap_array; // items in heap order
+    int *position; // position[item] = slot of item in heap_array, -1 if not queued
+    int *key; // key[item] = current key of item
+    int capacity; // number of possible items
+    int heap_size; // Current number of items in the queue
+
+public:
+    IndexedMinHeap(int capacity){
+        this->heap_size = 0;
+        this->capacity = capacity;
+        this->heap_array = (int *)malloc(sizeof(int) * capacity);
+        this->position = (int *)malloc(sizeof(int) * capacity);
+        this->key = (int *)malloc(sizeof(int) * capacity);
+        for(int i = 0; i < capacity; i++)
+            position[i] = -1;
+    }
+
+    ~IndexedMinHeap(){
+        free(heap_array);
+        free(position);
+        free(key);
+    }
+
+    bool is_empty(){ return heap_size == 0; }
+
+    bool contains(int item){ return position[item] != -1; }
+
+    int get_key(int item){ return key[item]; }
+
+    /**
+     * @brief Queues an item that is not in the heap yet
+     */
+    void insert(int item, int item_key){
+        int i = heap_size++;
+        heap_array[i] = item;
+        position[item] = i;
+        key[item] = item_key;
+        sift_up(i);
+    }
+
+    /**
+     * @brief Lowers the key of a queued item and moves it up the tree
+     *
+     * Keys greater than the current one are ignored.
+     */
+    void decrease_key(int item, int item_key){
+        if(item_key >= key[item])
+            return;
+        key[item] = item_key;
+        sift_up(position[item]);
+    }
+
+    /**
+     * @brief Removes and returns the item with the smallest key
+     */
+    int extract_min(){
+        int root = heap_array[0];
+
+        heap_size--;
+        position[root] = -1;
+
+        if(heap_size > 0){
+            heap_array[0] = heap_array[heap_size];
+            position[heap_array[0]] = 0;
+            sift_down(0);
+        }
+
+        return root;
+    }
+
+private:
+    int parent(int i){ return (i-1)/2; }
+    int left(int i){ return (2*i + 1); }
+    int right(int i){ return (2*i + 2); }
+
+    /**
+     * @brief Ties are broken by item number, so the order never depends on
+     * the insertion history
+     */
+    bool less(int a, int b){
+        return key[a] < key[b] || (key[a] == key[b] && a < b);
+    }
+
+    void swap_slots(int i, int j){
+        swap(heap_array[i], heap_array[j]);
+        position[heap_array[i]] = i;
+        position[heap_array[j]] = j;
+    }
+
+    void sift_up(int i){
+        while (i != 0 && less(heap_array[i], heap_array[parent(i)])){
+            swap_slots(i, parent(i));
+            i = parent(i);
+        }
+    }
+
+    void sift_down(int i){
+        while (true){
+            int l = left(i);
+            int r = right(i);
+
+            int smallest = i;
+            if (l < heap_size && less(heap_array[l], heap_array[smallest]))
+                smallest = l;
+            if (r < heap_size && less(heap_array[r], heap_array[smallest]))
+                smallest = r;
+
+            if (smallest == i)
+                return;
+
+            swap_slots(i, smallest);
+            i = smallest;
+        }
+    }
+};
@@ -0,0 +1,225 @@
+/**
+ * @file geometry/id_map.hpp
+ *
+ * @brief Compact numbering of the node IDs of the input file
+ *
+ * The solver works with node IDs 1 ... n (index = ID - 1 in assembly(),
+ * MeshGraph, the storages, ...), but a mesh exported after GiD deleted or
+ * renumbered entities may have gaps or arbitrary 64 bit IDs.
+ * IdMap assigns every file ID a compact ID that keeps the order of the file
+ * IDs (the smallest file ID becomes 1, the next one 2, ...) and translates
+ * back when results are written.
+ *
+ *  - IDs 1 ... n: the compact ID is the file ID, no table at all
+ *  - Dense IDs (span up to DIRECT_TABLE_FACTOR * n): a direct table,
+ *    table[id - min_id] = compact index, lookup O(1)
+ *  - Sparse IDs: the radix sorted list of IDs, lookup by binary search
+ *
+ * Lookups only happen while reading the file, everything after that uses
+ * the compact IDs stored in the nodes.
+ */
+#include <stdexcept>
+#include <string>
+
+#define DIRECT_TABLE_FACTOR 4
+
+class IdMap
+{
+private:
+    long long *original; // original[index] = file ID, ascending
+    int count;
+
+    long long min_id;
+    int *table;            // direct table, NULL when the IDs are sparse or 1 ... n
+    long long table_size;
+    bool identity;         // file IDs are 1 ... n
+
+    /**
+     * @brief LSD radix sort of 64 bit keys, 16 bits per pass
+     *
+     * Keys are shifted by the minimum so they are never negative, and passes
+     * where every key has the same digit are skipped, so small IDs only
+     * need one or two passes.
+     */
+    static void radix_sort(long long *keys, int n, long long minimum)
+    {
+        unsigned long long *a = (unsigned long long *)malloc(sizeof(unsigned long long) * n);
+        unsigned long long *b = (unsigned long long *)malloc(sizeof(unsigned long long) * n);
+        int *bucket = (int *)malloc(sizeof(int) * 65536);
+
+        unsigned long long all_bits = 0;
+        for (int i = 0; i < n; i++)
+        {
+            a[i] = (unsigned long long)(keys[i] - minimum);
+            all_bits |= a[i];
+        }
+
+        for (int shift = 0; shift < 64 && (all_bits >> shift) != 0; shift += 16)
+        {
+            for (int d = 0; d < 65536; d++)
+                bucket[d] = 0;
+            for (int i = 0; i < n; i++)
+                bucket[(a[i] >> shift) & 0xFFFF]++;
+
+            int position = 0;
+            for (int d = 0; d < 65536; d++)
+            {
+                int size = bucket[d];
+                bucket[d] = position;
+                position += size;
+            }
+
+            for (int i = 0; i < n; i++)
+                b[bucket[(a[i] >> shift) & 0xFFFF]++] = a[i];
+
+            swap(a, b);
+        }
+
+        for (int i = 0; i < n; i++)
+            keys[i] = (long long)a[i] + minimum;
+
+        free(a);
+        free(b);
+        free(bucket);
+    }
+
+public:
+    IdMap()
+    {
+        original = NULL;
+        count = 0;
+        min_id = 0;
+        table = NULL;
+        table_size = 0;
+        identity = true;
+    }
+
+    ~IdMap()
+    {
+        free(original);
+        free(table);
+    }
+
+    /**
+     * @brief Builds the map from the node IDs of the file, in any order
+     *
+     * Throws if an ID is repeated.
+     */
+    void build(long long *ids, int n)
+    {
+        count = n;
+        original = (long long *)malloc(sizeof(long long) * n);
+
+        if (n == 0)
+            return;
+
+        min_id = ids[0];
+        long long max_id = ids[0];
+        for (int i = 0; i < n; i++)
+        {
+            original[i] = ids[i];
+            if (ids[i] < min_id)
+                min_id = ids[i];
+            if (ids[i] > max_id)
+                max_id = ids[i];
+        }
+
+        radix_sort(original, n, min_id);
+
+        for (int i = 1; i < n; i++)
+            if (original[i] == original[i - 1])
+                throw runtime_error("Node ID " + to_string(original[i]) + " is repeated in Coordinates");
+
+        identity = original[0] == 1 && original[n - 1] == n;
+        if (identity)
+            return;
+
+        // Span computed unsigned, max_id - min_id can overflow a signed value
+        unsigned long long span = (unsigned long long)max_id - (unsigned long long)min_id + 1;
+        if (span <= (unsigned long long)DIRECT_TABLE_FACTOR * n)
+        {
+            table_size = (long long)span;
+            table = (int *)malloc(sizeof(int) * table_size);
+            for (long long t = 0; t < table_size; t++)
+                table[t] = -1;
+            for (int i = 0; i < n; i++)
+                table[original[i] - min_id] = i;
+        }
+    }
+
+    /**
+     * @brief Map of a file whose node IDs are known to be exactly 1 ... n
+     */
+    void build_identity(int n)
+    {
+        count = n;
+        original = (long long *)malloc(sizeof(long long) * n);
+        for (int i = 0; i < n; i++)
+            original[i] = i + 1;
+        min_id = 1;
+        identity = true;
+    }
+
+    /**
+     * @brief Compact index (compact ID - 1) of a file ID, -1 if it is not a node
+     */
+    int to_index(long long id)
+    {
+        if (identity)
+            return (id >= 1 && id <= count) ? (int)(id - 1) : -1;
+
+        if (table != NULL)
+        {
+            if (id < min_id || id - min_id >= table_size)
+                return -1;
+            return table[id - min_id];
+        }
+
+        int low = 0, high = count - 1;
+        while (low <= high)
+        {
+            int middle = low + (high - low) / 2;
+            if (original[middle] == id)
+                return middle;
+            if (original[middle] < id)
+                low = middle + 1;
+            else
+                high = middle - 1;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Compact index of a file ID, throws if the ID is not a node
+     *
+     * @param section Section of the input file, for the error message
+     */
+    int require_index(long long id, const char *section)
+    {
+        int index = to_index(id);
+        if (index == -1)
+            throw runtime_error(string(section) + " references node ID " + to_string(id) + ", missing in Coordinates");
+        return index;
+    }
+
+    /**
+     * @brief File ID of a compact index
+     */
+    long long to_id(int index)
+    {
+        return original[index];
+    }
+
+    bool is_direct()
+    {
+        return identity || table != NULL;
+    }
+
+    /**
+     * @brief True when the file IDs already are 1 ... n
+     */
+    bool is_identity()
+    {
+        return identity;
+    }
+};
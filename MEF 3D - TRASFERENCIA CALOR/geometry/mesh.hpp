@@ -1,6 +1,20 @@
-#include "node.hpp"
+#include <new>
+#include <cmath>
+
+#include "node_store.hpp"
 #include "element.hpp"
 #include "condition.hpp"
+#include "mesh_graph.hpp"
+#include "id_map.hpp"
+#include "../gid/mapped_file.hpp"
+#include "../mef_utilities/logger.hpp"
+
+/**
+ * @brief Node storage policy, see node_store.hpp
+ */
+#ifndef NODE_STORAGE
+#define NODE_STORAGE ArrayNodeStorage
+#endif
 
 /**
  * @brief Heat Transfer Model Constants
@@ -10,7 +24,9 @@
 enum parameter
 {
     THERMAL_CONDUCTIVITY, // K in Heat Transfer Ecuation
-    HEAT_SOURCE           // Q in Heat Transfer Ecuation
+    HEAT_SOURCE,          // Q in Heat Transfer Ecuation
+    DIRICHLET_VALUE,      // T_bar, value of every dirichlet condition
+    NEUMANN_VALUE         // T_hat, value of every neumann condition
 };
 
 /**
@@ -36,7 +52,7 @@ class Mesh
 {
 
 private:
-    float problem_data[2]; // Array list of constants values for especified model
+    float problem_data[4]; // Array list of constants values for especified model
     int quantities[4];   // Array list of FEM values sizes
 
     /**
@@ -47,16 +63,55 @@ private:
      */
     ///@{
 
-    Node** nodes;                     // Mesh Node list
+    NodeStore<NODE_STORAGE> nodes;   // Mesh Node list
     Element **elements;               // Mesh Elements list
     Condition **dirichlet_conditions; // Mesh Dirichelet Conditions list
     Condition **neumann_conditions;   // Mesh Nueman Conditions list
     ///@}
 
-    
+    /**
+     *  @name Structure of arrays
+     *
+     *  Flat copy of the mesh filled by the readers, indexed by compact index
+     *  (ID - 1). build_entities() creates the objects above from them.
+     */
+    ///@{
+    float *x, *y, *z;     // Node coordinates
+    int *connectivity;    // 4 node indices per element
+    int *element_ids;     // Element IDs of the input file
+    int *dirichlet_nodes; // Node index of each dirichlet condition
+    int *neumann_nodes;   // Node index of each neumann condition
+    ///@}
+
+    MappedFile storage; // .meshbin file the structure of arrays points into, see use_arrays()
+    bool arrays_mapped;
+
+    // Objects created by build_entities(), one block each
+    Node *node_pool;
+    Element *element_pool;
+    Condition *condition_pool;
+
+    MeshGraph *graph; // Adjacency graphs, built on first use by get_graph()
+
+    IdMap node_ids; // Node IDs of the input file <-> compact node IDs
 
 public:
-    Mesh() {}
+    Mesh()
+    {
+        graph = NULL;
+        elements = NULL;
+        dirichlet_conditions = NULL;
+        neumann_conditions = NULL;
+        x = y = z = NULL;
+        connectivity = NULL;
+        element_ids = NULL;
+        dirichlet_nodes = NULL;
+        neumann_nodes = NULL;
+        node_pool = NULL;
+        element_pool = NULL;
+        condition_pool = NULL;
+        arrays_mapped = false;
+    }
 
     /**
      * @brief Destroy the Mesh object
@@ -66,10 +121,23 @@ public:
      */
     ~Mesh()
     {
-        free(nodes);
         free(elements);
         free(dirichlet_conditions);
         free(neumann_conditions);
+        if (!arrays_mapped)
+        {
+            free(x);
+            free(y);
+            free(z);
+            free(connectivity);
+            free(element_ids);
+            free(dirichlet_nodes);
+            free(neumann_nodes);
+        }
+        free(node_pool);
+        free(element_pool);
+        free(condition_pool);
+        delete graph;
     }
 
     void set_problem_data(float k, float Q)
@@ -77,6 +145,11 @@ public:
         problem_data[THERMAL_CONDUCTIVITY] = k;
         problem_data[HEAT_SOURCE] = Q;
     }
+    void set_boundary_values(float T_bar, float T_hat)
+    {
+        problem_data[DIRICHLET_VALUE] = T_bar;
+        problem_data[NEUMANN_VALUE] = T_hat;
+    }
     float get_problem_data(parameter position)
     {
         return problem_data[position];
@@ -100,22 +173,139 @@ public:
      */
     void init_arrays()
     {
-        nodes = (Node **)malloc(sizeof(Node *) * quantities[NUM_NODES]);
+        init_entity_arrays();
+
+        x = (float *)malloc(sizeof(float) * quantities[NUM_NODES]);
+        y = (float *)malloc(sizeof(float) * quantities[NUM_NODES]);
+        z = (float *)malloc(sizeof(float) * quantities[NUM_NODES]);
+        connectivity = (int *)malloc(sizeof(int) * 4 * quantities[NUM_ELEMENTS]);
+        element_ids = (int *)malloc(sizeof(int) * quantities[NUM_ELEMENTS]);
+        dirichlet_nodes = (int *)malloc(sizeof(int) * quantities[NUM_DIRICHLET]);
+        neumann_nodes = (int *)malloc(sizeof(int) * quantities[NUM_NEUMANN]);
+    }
+
+    /**
+     * @brief Allocates only the node, element and condition lists
+     */
+    void init_entity_arrays()
+    {
+        nodes.init(quantities[NUM_NODES]);
         elements = (Element **)malloc(sizeof(Element *) * quantities[NUM_ELEMENTS]);
         dirichlet_conditions = (Condition **)malloc(sizeof(Condition *) * quantities[NUM_DIRICHLET]);
         neumann_conditions = (Condition **)malloc(sizeof(Condition *) * quantities[NUM_NEUMANN]);
     }
 
+    /**
+     * @brief Points the structure of arrays into get_storage(), instead of init_arrays()
+     *
+     * The arrays are used in place and not freed, the mapping stays open
+     * while the mesh exists.
+     */
+    void use_arrays(float *x_values, float *y_values, float *z_values, int *connectivity_values, int *element_id_values,
+                    int *dirichlet_values, int *neumann_values)
+    {
+        x = x_values;
+        y = y_values;
+        z = z_values;
+        connectivity = connectivity_values;
+        element_ids = element_id_values;
+        dirichlet_nodes = dirichlet_values;
+        neumann_nodes = neumann_values;
+        arrays_mapped = true;
+    }
+
+    MappedFile *get_storage()
+    {
+        return &storage;
+    }
+
+    /**
+     * @brief Creates the nodes, elements and conditions from the structure of arrays
+     *
+     * Each kind of object is placed in a single block instead of one
+     * allocation per object. Node i gets the compact ID i + 1.
+     */
+    void build_entities()
+    {
+        int num_nodes = quantities[NUM_NODES];
+        int num_elements = quantities[NUM_ELEMENTS];
+        int num_dirichlet = quantities[NUM_DIRICHLET];
+        int num_neumann = quantities[NUM_NEUMANN];
+
+        node_pool = (Node *)malloc(sizeof(Node) * num_nodes);
+        for (int i = 0; i < num_nodes; i++)
+            new (&node_pool[i]) Node(i + 1, x[i], y[i], z[i]);
+        nodes.build(node_pool, num_nodes);
+
+        element_pool = (Element *)malloc(sizeof(Element) * num_elements);
+        for (int e = 0; e < num_elements; e++)
+        {
+            int *element_nodes = &connectivity[4 * e];
+            new (&element_pool[e]) Element(element_ids[e], &node_pool[element_nodes[0]], &node_pool[element_nodes[1]],
+                                           &node_pool[element_nodes[2]], &node_pool[element_nodes[3]]);
+            elements[e] = &element_pool[e];
+        }
+
+        condition_pool = (Condition *)malloc(sizeof(Condition) * (num_dirichlet + num_neumann));
+        for (int i = 0; i < num_dirichlet; i++)
+        {
+            new (&condition_pool[i]) Condition(&node_pool[dirichlet_nodes[i]], problem_data[DIRICHLET_VALUE]);
+            dirichlet_conditions[i] = &condition_pool[i];
+        }
+        for (int i = 0; i < num_neumann; i++)
+        {
+            Condition *condition = &condition_pool[num_dirichlet + i];
+            new (condition) Condition(&node_pool[neumann_nodes[i]], problem_data[NEUMANN_VALUE]);
+            neumann_conditions[i] = condition;
+        }
+    }
+
+    /**
+     * @name Structure of arrays access, valid after init_arrays()
+     */
+    ///@{
+    float *get_x_coordinates()
+    {
+        return x;
+    }
+    float *get_y_coordinates()
+    {
+        return y;
+    }
+    float *get_z_coordinates()
+    {
+        return z;
+    }
+    int *get_connectivity()
+    {
+        return connectivity;
+    }
+    int *get_element_ids()
+    {
+        return element_ids;
+    }
+    int *get_dirichlet_nodes()
+    {
+        return dirichlet_nodes;
+    }
+    int *get_neumann_nodes()
+    {
+        return neumann_nodes;
+    }
+    ///@}
+
 
     // Basic SETTER AND GETTERS
-    void insert_node(Node *node, int position)
+    // The node storage places it by its ID
+    void insert_node(Node *node)
     {
-        nodes[position] = node;
+        nodes.insert(node);
     }
 
+    // Node with ID position + 1
     Node *get_node(int position)
     {
-        return nodes[position];
+        return nodes.find(position + 1);
     }
 
     void insert_element(Element *element, int position)
@@ -161,8 +351,56 @@ public:
         return neumann_conditions[position];
     }
 
+    /**
+     * @brief Translation between the node IDs of the input file and the
+     * compact IDs 1 ... n of the nodes
+     */
+    IdMap *get_node_ids()
+    {
+        return &node_ids;
+    }
+
+    /**
+     * @brief Node -> element and node -> node adjacency of the mesh
+     *
+     * The graphs are built the first time they are requested and cached,
+     * so every element must already be inserted when this is called.
+     */
+    bool has_graph()
+    {
+        return graph != NULL;
+    }
+
+    /**
+     * @brief Uses a graph built elsewhere, the mesh deletes it
+     */
+    void set_graph(MeshGraph *mesh_graph)
+    {
+        delete graph;
+        graph = mesh_graph;
+    }
+
+    MeshGraph *get_graph()
+    {
+        if (graph == NULL)
+        {
+            graph = new MeshGraph();
+            graph->build(elements, quantities[NUM_ELEMENTS], quantities[NUM_NODES]);
+        }
+        return graph;
+    }
+
+    /**
+     * @brief Summary of the mesh: problem data, sizes, bounding box and element volumes
+     *
+     * The full listing of nodes, elements and conditions is only printed at
+     * LOG_DEBUG, it was the slowest part of a run on large meshes.
+     */
     void report()
     {
+        if (!log_enabled(LOG_SUMMARY))
+            return;
+
         cout << "Problem Data\n**********************\n";
         cout << "Thermal Conductivity: " << problem_data[THERMAL_CONDUCTIVITY] << "\n";
         cout << "Heat Source: " << problem_data[HEAT_SOURCE] << "\n\n";
@@ -171,21 +409,73 @@ public:
         cout << "Number of elements: " << quantities[NUM_ELEMENTS] << "\n";
         cout << "Number of dirichlet boundary conditions: " << quantities[NUM_DIRICHLET] << "\n";
         cout << "Number of neumann boundary conditions: " << quantities[NUM_NEUMANN] << "\n\n";
+
+        if (quantities[NUM_NODES] > 0)
+        {
+            float min_corner[3] = {x[0], y[0], z[0]}, max_corner[3] = {x[0], y[0], z[0]};
+            for (int i = 1; i < quantities[NUM_NODES]; i++)
+            {
+                float point[3] = {x[i], y[i], z[i]};
+                for (int d = 0; d < 3; d++)
+                {
+                    min_corner[d] = point[d] < min_corner[d] ? point[d] : min_corner[d];
+                    max_corner[d] = point[d] > max_corner[d] ? point[d] : max_corner[d];
+                }
+            }
+            cout << "Bounding box: (" << min_corner[0] << ", " << min_corner[1] << ", " << min_corner[2] << ") - ("
+                 << max_corner[0] << ", " << max_corner[1] << ", " << max_corner[2] << ")\n";
+        }
+
+        if (quantities[NUM_ELEMENTS] > 0)
+        {
+            // Volume of a tetrahedron = |det[edges from node 1]| / 6
+            double min_volume = 0, max_volume = 0, total_volume = 0;
+            int degenerate = 0;
+            for (int e = 0; e < quantities[NUM_ELEMENTS]; e++)
+            {
+                int *n = &connectivity[4 * e];
+                double a[3] = {x[n[1]] - x[n[0]], y[n[1]] - y[n[0]], z[n[1]] - z[n[0]]};
+                double b[3] = {x[n[2]] - x[n[0]], y[n[2]] - y[n[0]], z[n[2]] - z[n[0]]};
+                double c[3] = {x[n[3]] - x[n[0]], y[n[3]] - y[n[0]], z[n[3]] - z[n[0]]};
+                double volume = fabs(a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) +
+                                     a[2] * (b[0] * c[1] - b[1] * c[0])) / 6;
+
+                if (e == 0 || volume < min_volume)
+                    min_volume = volume;
+                if (volume > max_volume)
+                    max_volume = volume;
+                total_volume += volume;
+                if (volume == 0)
+                    degenerate++;
+            }
+            cout << "Element volume: min " << min_volume << ", max " << max_volume << ", mean "
+                 << total_volume / quantities[NUM_ELEMENTS] << ", total " << total_volume << "\n";
+            if (degenerate > 0)
+                cout << "Degenerate elements (zero volume): " << degenerate << "\n";
+        }
+        cout << "\n";
+
+        if (!log_enabled(LOG_DEBUG))
+            return;
+
         cout << "List of nodes\n**********************\n";
         for (int i = 0; i < quantities[NUM_NODES]; i++)
-            cout << "Node: " << nodes[i]->get_ID() << ", x= " << nodes[i]->get_x_coordinate() << ", y= " << nodes[i]->get_y_coordinate() << ", z= " << nodes[i]->get_z_coordinate() << "\n";
+        {
+            Node *node = get_node(i);
+            cout << "Node: " << node_ids.to_id(i) << ", x= " << node->get_x_coordinate() << ", y= " << node->get_y_coordinate() << ", z= " << node->get_z_coordinate() << "\n";
+        }
         cout << "\nList of elements\n**********************\n";
         for (int i = 0; i < quantities[NUM_ELEMENTS]; i++)
         {
-            cout << "Element: " << elements[i]->get_ID() << ", Node 1= " << elements[i]->get_node1()->get_ID();
-            cout << ", Node 2= " << elements[i]->get_node2()->get_ID() << ", Node 3= " << elements[i]->get_node3()->get_ID() << "Node 4= " << elements[i]->get_node4()->get_ID() << "\n";
+            cout << "Element: " << elements[i]->get_ID() << ", Node 1= " << node_ids.to_id(elements[i]->get_node1()->get_ID() - 1);
+            cout << ", Node 2= " << node_ids.to_id(elements[i]->get_node2()->get_ID() - 1) << ", Node 3= " << node_ids.to_id(elements[i]->get_node3()->get_ID() - 1) << "Node 4= " << node_ids.to_id(elements[i]->get_node4()->get_ID() - 1) << "\n";
         }
         cout << "\nList of Dirichlet boundary conditions\n**********************\n";
         for (int i = 0; i < quantities[NUM_DIRICHLET]; i++)
-            cout << "Condition " << i + 1 << ": " << dirichlet_conditions[i]->get_node()->get_ID() << ", Value= " << dirichlet_conditions[i]->get_value() << "\n";
+            cout << "Condition " << i + 1 << ": " << node_ids.to_id(dirichlet_conditions[i]->get_node()->get_ID() - 1) << ", Value= " << dirichlet_conditions[i]->get_value() << "\n";
         cout << "\nList of Neumann boundary conditions\n**********************\n";
         for (int i = 0; i < quantities[NUM_NEUMANN]; i++)
-            cout << "Condition " << i + 1 << ": " << neumann_conditions[i]->get_node()->get_ID() << ", Value= " << neumann_conditions[i]->get_value() << "\n";
+            cout << "Condition " << i + 1 << ": " << node_ids.to_id(neumann_conditions[i]->get_node()->get_ID() - 1) << ", Value= " << neumann_conditions[i]->get_value() << "\n";
         cout << "\n";
     }
 };
\ No newline at end of file
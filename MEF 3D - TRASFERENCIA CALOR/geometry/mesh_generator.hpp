@@ -0,0 +1,269 @@
+/**
+ * @file geometry/mesh_generator.hpp
+ *
+ * @brief Structured tetrahedral meshes of a box, for scaling studies
+ *
+ * The box [0, size_x] x [0, size_y] x [0, size_z] is divided in
+ * cells_x * cells_y * cells_z cubes and every cube is split in tetrahedra:
+ *
+ *  - SPLIT_5_TETRAHEDRA: a central tetrahedron and one on each of 4 corners,
+ *    like the sample input.dat. Neighbour cubes use the mirrored split, so
+ *    the diagonals of shared faces match
+ *  - SPLIT_6_TETRAHEDRA: 6 tetrahedra around the main diagonal of the cube
+ *    (Kuhn split), the same in every cube
+ *
+ * Nodes are numbered x first, then y, then z, with IDs 1 ... n. Elements
+ * follow the cubes in the same order and are oriented with a positive
+ * jacobian, as create_local_b() expects.
+ *
+ * Dirichlet and Neumann nodes are the nodes on the chosen faces of the box,
+ * in ascending order. A node on both kinds of faces is only Dirichlet.
+ */
+#include <climits>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+enum cube_split
+{
+    SPLIT_5_TETRAHEDRA = 5,
+    SPLIT_6_TETRAHEDRA = 6
+};
+
+/**
+ * @brief Faces of the box, combined as a bit mask
+ */
+enum box_face
+{
+    FACE_X_MIN = 1,
+    FACE_X_MAX = 2,
+    FACE_Y_MIN = 4,
+    FACE_Y_MAX = 8,
+    FACE_Z_MIN = 16,
+    FACE_Z_MAX = 32
+};
+
+struct BoxMeshSpec
+{
+    int cells[3];    // cubes along x, y, z
+    float size[3];   // box length along x, y, z
+    cube_split split;
+    int dirichlet_faces; // box_face mask
+    int neumann_faces;   // box_face mask
+    float k, Q, T_bar, T_hat;
+};
+
+/**
+ * @brief Default spec: the problem data of input.dat, Dirichlet on z min and
+ * Neumann on z max of a unit-spaced box
+ */
+BoxMeshSpec box_mesh_spec(int cells_x, int cells_y, int cells_z)
+{
+    BoxMeshSpec spec = {{cells_x, cells_y, cells_z}, {(float)cells_x, (float)cells_y, (float)cells_z},
+                        SPLIT_5_TETRAHEDRA, FACE_Z_MIN, FACE_Z_MAX, 8.3, 2000, 350, 200};
+    return spec;
+}
+
+/**
+ * @brief Face mask from a list such as "xmin,zmax", "all" or "none"
+ */
+int parse_box_faces(string list)
+{
+    static const char *names[6] = {"xmin", "xmax", "ymin", "ymax", "zmin", "zmax"};
+    if (list == "all")
+        return 63;
+    if (list == "none")
+        return 0;
+
+    int mask = 0;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == string::npos)
+            end = list.size();
+        string name = list.substr(start, end - start);
+
+        int face = 0;
+        for (int f = 0; f < 6; f++)
+            if (name == names[f])
+                face = 1 << f;
+        if (face == 0)
+            throw runtime_error("Unknown box face '" + name + "', expected xmin, xmax, ymin, ymax, zmin, zmax, all or none");
+        mask |= face;
+        start = end + 1;
+    }
+    return mask;
+}
+
+/**
+ * @brief Corners of a cube as bits x | y << 1 | z << 2
+ */
+static const int split_5_even[5][4] = {{1, 2, 4, 7}, {0, 1, 2, 4}, {3, 1, 2, 7}, {5, 1, 4, 7}, {6, 2, 4, 7}};
+static const int split_5_odd[5][4] = {{0, 3, 5, 6}, {1, 0, 3, 5}, {2, 0, 3, 6}, {4, 0, 5, 6}, {7, 3, 5, 6}};
+static const int split_6[6][4] = {{0, 1, 3, 7}, {0, 1, 5, 7}, {0, 2, 3, 7}, {0, 2, 6, 7}, {0, 4, 5, 7}, {0, 4, 6, 7}};
+
+/**
+ * @brief Copies a split template, swapping the last two corners of every
+ * tetrahedron with a negative volume in the unit cube
+ */
+void orient_split(const int (*split)[4], int count, int (*oriented)[4])
+{
+    for (int t = 0; t < count; t++)
+    {
+        float corner[4][3];
+        for (int v = 0; v < 4; v++)
+        {
+            oriented[t][v] = split[t][v];
+            corner[v][0] = split[t][v] & 1;
+            corner[v][1] = (split[t][v] >> 1) & 1;
+            corner[v][2] = (split[t][v] >> 2) & 1;
+        }
+
+        float a[3], b[3], c[3];
+        for (int d = 0; d < 3; d++)
+        {
+            a[d] = corner[1][d] - corner[0][d];
+            b[d] = corner[2][d] - corner[0][d];
+            c[d] = corner[3][d] - corner[0][d];
+        }
+        float volume = a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) + a[2] * (b[0] * c[1] - b[1] * c[0]);
+        if (volume < 0)
+        {
+            oriented[t][2] = split[t][3];
+            oriented[t][3] = split[t][2];
+        }
+    }
+}
+
+/**
+ * @brief Faces of the box that contain node (i, j, k)
+ */
+int node_faces(BoxMeshSpec *spec, int i, int j, int k)
+{
+    int faces = 0;
+    int position[3] = {i, j, k};
+    for (int d = 0; d < 3; d++)
+    {
+        if (position[d] == 0)
+            faces |= 1 << (2 * d);
+        if (position[d] == spec->cells[d])
+            faces |= 2 << (2 * d);
+    }
+    return faces;
+}
+
+/**
+ * @brief Fills M with the mesh of the box, throws if it does not fit the
+ * 32 bit indices of Mesh
+ */
+void generate_box_mesh(BoxMeshSpec *spec, Mesh *M)
+{
+    for (int d = 0; d < 3; d++)
+        if (spec->cells[d] < 1 || spec->size[d] <= 0)
+            throw runtime_error("The box needs at least one cell and a positive length along every axis");
+    if (spec->split != SPLIT_5_TETRAHEDRA && spec->split != SPLIT_6_TETRAHEDRA)
+        throw runtime_error("Cubes can only be split in 5 or 6 tetrahedra");
+
+    long long points[3] = {spec->cells[0] + 1LL, spec->cells[1] + 1LL, spec->cells[2] + 1LL};
+    long long nodes = points[0] * points[1] * points[2];
+    long long cubes = (long long)spec->cells[0] * spec->cells[1] * spec->cells[2];
+    long long elements = cubes * spec->split;
+    if (nodes > INT_MAX || elements > INT_MAX / 4)
+        throw runtime_error("A box of " + to_string(nodes) + " nodes and " + to_string(elements) +
+                            " elements does not fit the 32 bit indices of the mesh");
+
+    int num_nodes = (int)nodes;
+    int num_elements = (int)elements;
+    int nx = (int)points[0], ny = (int)points[1], nz = (int)points[2];
+
+    // Boundary nodes, in ascending order
+    int num_dirichlet = 0, num_neumann = 0;
+    for (int k = 0; k < nz; k++)
+        for (int j = 0; j < ny; j++)
+            for (int i = 0; i < nx; i++)
+            {
+                int faces = node_faces(spec, i, j, k);
+                if (faces & spec->dirichlet_faces)
+                    num_dirichlet++;
+                else if (faces & spec->neumann_faces)
+                    num_neumann++;
+            }
+
+    M->set_problem_data(spec->k, spec->Q);
+    M->set_boundary_values(spec->T_bar, spec->T_hat);
+    M->set_quantities(num_nodes, num_elements, num_dirichlet, num_neumann);
+    M->init_arrays();
+    M->get_node_ids()->build_identity(num_nodes);
+
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+    float step[3] = {spec->size[0] / spec->cells[0], spec->size[1] / spec->cells[1], spec->size[2] / spec->cells[2]};
+
+#pragma omp parallel for
+    for (int k = 0; k < nz; k++)
+        for (int j = 0; j < ny; j++)
+            for (int i = 0; i < nx; i++)
+            {
+                int node = (k * ny + j) * nx + i;
+                // The last layer is exactly at the box size, not a sum of steps
+                x[node] = i == spec->cells[0] ? spec->size[0] : i * step[0];
+                y[node] = j == spec->cells[1] ? spec->size[1] : j * step[1];
+                z[node] = k == spec->cells[2] ? spec->size[2] : k * step[2];
+            }
+
+    int even[6][4], odd[6][4];
+    if (spec->split == SPLIT_5_TETRAHEDRA)
+    {
+        orient_split(split_5_even, 5, even);
+        orient_split(split_5_odd, 5, odd);
+    }
+    else
+    {
+        orient_split(split_6, 6, even);
+        orient_split(split_6, 6, odd);
+    }
+
+    int *connectivity = M->get_connectivity();
+    int *element_ids = M->get_element_ids();
+    int per_cube = spec->split;
+
+#pragma omp parallel for
+    for (int k = 0; k < spec->cells[2]; k++)
+        for (int j = 0; j < spec->cells[1]; j++)
+            for (int i = 0; i < spec->cells[0]; i++)
+            {
+                long long cube = ((long long)k * spec->cells[1] + j) * spec->cells[0] + i;
+                int(*split)[4] = (i + j + k) % 2 == 0 ? even : odd;
+
+                int corner_node[8];
+                for (int c = 0; c < 8; c++)
+                    corner_node[c] = ((k + (c >> 2)) * ny + j + ((c >> 1) & 1)) * nx + i + (c & 1);
+
+                for (int t = 0; t < per_cube; t++)
+                {
+                    int e = (int)(cube * per_cube + t);
+                    for (int v = 0; v < 4; v++)
+                        connectivity[4 * e + v] = corner_node[split[t][v]];
+                    element_ids[e] = e + 1;
+                }
+            }
+
+    int *dirichlet_nodes = M->get_dirichlet_nodes();
+    int *neumann_nodes = M->get_neumann_nodes();
+    int d = 0, n = 0;
+    for (int k = 0; k < nz; k++)
+        for (int j = 0; j < ny; j++)
+            for (int i = 0; i < nx; i++)
+            {
+                int faces = node_faces(spec, i, j, k);
+                int node = (k * ny + j) * nx + i;
+                if (faces & spec->dirichlet_faces)
+                    dirichlet_nodes[d++] = node;
+                else if (faces & spec->neumann_faces)
+                    neumann_nodes[n++] = node;
+            }
+
+    M->build_entities();
+}
@@ -0,0 +1,292 @@
+/**
+ * @file geometry/mesh_graph.hpp
+ *
+ * @brief Mesh adjacency graphs in CSR form
+ *
+ * Sparse assembly, renumbering, coloring and partitioning all need to know
+ * which elements touch a node and which nodes share an element with it.
+ * This class builds both relations from the element connectivity:
+ *
+ *  - node to element: elements that contain node i are
+ *      element_index[element_offset[i]] ... element_index[element_offset[i+1]-1]
+ *  - node to node: nodes that share at least one element with node i
+ *    (node i itself is not listed) are
+ *      node_index[node_offset[i]] ... node_index[node_offset[i+1]-1]
+ *
+ * Both graphs are built with a two-pass counting sort: first every row is
+ * counted, a prefix sum turns the counts into offsets and then a second pass
+ * fills the rows in place, so there is no per-node std::vector.
+ * Loops are parallelized with OpenMP when compiled with -fopenmp, without it
+ * the pragmas are ignored and the build is serial. Every row is sorted at the
+ * end so the result does not depend on the number of threads.
+ *
+ * Nodes are indexed as in assembly(): index = node ID - 1
+ */
+class MeshGraph
+{
+private:
+    int num_nodes;
+    int num_elements;
+
+    int *element_offset; // num_nodes + 1 row offsets of node -> element graph
+    int *element_index;  // element positions, 4 * num_elements values
+
+    int *node_offset; // num_nodes + 1 row offsets of node -> node graph
+    int *node_index;  // neighbour node indices
+
+    bool owned; // false when the arrays belong to a mapped file, see adopt()
+
+    /**
+     * @brief Sorts a short row in place, rows have tens of entries so
+     * insertion sort is enough
+     */
+    static void sort_row(int *row, int size)
+    {
+        for (int i = 1; i < size; i++)
+        {
+            int value = row[i];
+            int j = i - 1;
+            while (j >= 0 && row[j] > value)
+            {
+                row[j + 1] = row[j];
+                j--;
+            }
+            row[j + 1] = value;
+        }
+    }
+
+    /**
+     * @brief Turns a count array of size n + 1 (counts at 1..n) into offsets
+     */
+    static void prefix_sum(int *offset, int n)
+    {
+        offset[0] = 0;
+        for (int i = 0; i < n; i++)
+            offset[i + 1] += offset[i];
+    }
+
+    void build_node_to_element(Element **elements)
+    {
+        element_offset = (int *)calloc(num_nodes + 1, sizeof(int));
+        element_index = (int *)malloc(sizeof(int) * 4 * num_elements);
+
+        // First pass: count the elements of each node
+        #pragma omp parallel for
+        for (int e = 0; e < num_elements; e++)
+        {
+            int nodes[4];
+            get_element_nodes(elements[e], nodes);
+            for (int k = 0; k < 4; k++)
+            {
+                #pragma omp atomic
+                element_offset[nodes[k] + 1]++;
+            }
+        }
+
+        prefix_sum(element_offset, num_nodes);
+
+        // Second pass: place each element in the rows of its nodes
+        int *cursor = (int *)malloc(sizeof(int) * num_nodes);
+        for (int i = 0; i < num_nodes; i++)
+            cursor[i] = element_offset[i];
+
+        #pragma omp parallel for
+        for (int e = 0; e < num_elements; e++)
+        {
+            int nodes[4];
+            get_element_nodes(elements[e], nodes);
+            for (int k = 0; k < 4; k++)
+            {
+                int slot;
+                #pragma omp atomic capture
+                slot = cursor[nodes[k]]++;
+                element_index[slot] = e;
+            }
+        }
+        free(cursor);
+
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int i = 0; i < num_nodes; i++)
+            sort_row(&element_index[element_offset[i]], element_offset[i + 1] - element_offset[i]);
+    }
+
+    /**
+     * @brief Builds node -> node from node -> element
+     *
+     * Each thread keeps a single marker array of num_nodes values, marker[j] == i
+     * means j was already counted for row i, so duplicated neighbours coming from
+     * several elements are skipped without any extra storage per node.
+     */
+    void build_node_to_node(Element **elements)
+    {
+        node_offset = (int *)calloc(num_nodes + 1, sizeof(int));
+
+        #pragma omp parallel
+        {
+            int *marker = (int *)malloc(sizeof(int) * num_nodes);
+            for (int j = 0; j < num_nodes; j++)
+                marker[j] = -1;
+
+            // First pass: count unique neighbours
+            #pragma omp for schedule(dynamic, 256)
+            for (int i = 0; i < num_nodes; i++)
+            {
+                int count = 0;
+                marker[i] = i;
+                for (int p = element_offset[i]; p < element_offset[i + 1]; p++)
+                {
+                    int nodes[4];
+                    get_element_nodes(elements[element_index[p]], nodes);
+                    for (int k = 0; k < 4; k++)
+                        if (marker[nodes[k]] != i)
+                        {
+                            marker[nodes[k]] = i;
+                            count++;
+                        }
+                }
+                node_offset[i + 1] = count;
+            }
+
+            #pragma omp single
+            {
+                prefix_sum(node_offset, num_nodes);
+                node_index = (int *)malloc(sizeof(int) * node_offset[num_nodes]);
+            }
+
+            for (int j = 0; j < num_nodes; j++)
+                marker[j] = -1;
+
+            // Second pass: fill the rows
+            #pragma omp for schedule(dynamic, 256)
+            for (int i = 0; i < num_nodes; i++)
+            {
+                int slot = node_offset[i];
+                marker[i] = i;
+                for (int p = element_offset[i]; p < element_offset[i + 1]; p++)
+                {
+                    int nodes[4];
+                    get_element_nodes(elements[element_index[p]], nodes);
+                    for (int k = 0; k < 4; k++)
+                        if (marker[nodes[k]] != i)
+                        {
+                            marker[nodes[k]] = i;
+                            node_index[slot++] = nodes[k];
+                        }
+                }
+                sort_row(&node_index[node_offset[i]], node_offset[i + 1] - node_offset[i]);
+            }
+
+            free(marker);
+        }
+    }
+
+public:
+    MeshGraph()
+    {
+        num_nodes = 0;
+        num_elements = 0;
+        element_offset = NULL;
+        element_index = NULL;
+        node_offset = NULL;
+        node_index = NULL;
+        owned = true;
+    }
+
+    ~MeshGraph()
+    {
+        if (!owned)
+            return;
+        free(element_offset);
+        free(element_index);
+        free(node_offset);
+        free(node_index);
+    }
+
+    /**
+     * @brief Writes the 0-based node indices of an element into nodes[4]
+     */
+    static void get_element_nodes(Element *element, int *nodes)
+    {
+        nodes[0] = element->get_node1()->get_ID() - 1;
+        nodes[1] = element->get_node2()->get_ID() - 1;
+        nodes[2] = element->get_node3()->get_ID() - 1;
+        nodes[3] = element->get_node4()->get_ID() - 1;
+    }
+
+    /**
+     * @brief Builds both graphs from the element list
+     *
+     * @param elements Mesh element list
+     * @param element_count Number of elements
+     * @param node_count Number of nodes
+     */
+    void build(Element **elements, int element_count, int node_count)
+    {
+        num_nodes = node_count;
+        num_elements = element_count;
+
+        build_node_to_element(elements);
+        build_node_to_node(elements);
+    }
+
+    /**
+     * @brief Uses graphs built earlier, e.g. stored in a .meshbin file
+     *
+     * The arrays are not copied nor freed, they must outlive the graph.
+     */
+    void adopt(int node_count, int element_count, int *element_offsets, int *element_indices, int *node_offsets, int *node_indices)
+    {
+        num_nodes = node_count;
+        num_elements = element_count;
+        element_offset = element_offsets;
+        element_index = element_indices;
+        node_offset = node_offsets;
+        node_index = node_indices;
+        owned = false;
+    }
+
+    int get_num_nodes()
+    {
+        return num_nodes;
+    }
+
+    /**
+     * @name Node -> element graph
+     */
+    ///@{
+    int *get_element_offsets()
+    {
+        return element_offset;
+    }
+    int *get_element_indices()
+    {
+        return element_index;
+    }
+    int count_elements_of(int node)
+    {
+        return element_offset[node + 1] - element_offset[node];
+    }
+    ///@}
+
+    /**
+     * @name Node -> node graph
+     */
+    ///@{
+    int *get_node_offsets()
+    {
+        return node_offset;
+    }
+    int *get_node_indices()
+    {
+        return node_index;
+    }
+    int count_neighbours_of(int node)
+    {
+        return node_offset[node + 1] - node_offset[node];
+    }
+    int get_num_edges()
+    {
+        return node_offset[num_nodes] / 2;
+    }
+    ///@}
+};
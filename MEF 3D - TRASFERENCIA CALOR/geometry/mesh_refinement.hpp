@@ -0,0 +1,396 @@
+/**
+ * @file geometry/mesh_refinement.hpp
+ *
+ * @brief Uniform 1:8 refinement of a tetrahedral mesh
+ *
+ * Every edge gets a node at its midpoint and every tetrahedron is split in
+ * 8 (Bey's red refinement): one tetrahedron on each corner and 4 around
+ * the shortest diagonal of the inner octahedron, which keeps the quality
+ * of the elements over several levels. Children keep the orientation of
+ * their element, so a mesh with positive jacobians stays positive.
+ *
+ * Midpoints are unique per edge: edges are keys (smaller index, larger
+ * index) of an open addressing hash table filled by all threads at once.
+ * The table is sized from the exact edge count of the node -> node graph.
+ * New nodes are numbered after the old ones in the order of the first
+ * element that has their edge, so the result does not depend on the
+ * number of threads, and element e becomes elements 8e ... 8e + 7.
+ *
+ * Boundary conditions are nodal in this code, a midpoint gets one when its
+ * edge lies on a boundary face (a face of only one element) whose three
+ * nodes have conditions: Dirichlet if the three are Dirichlet, Neumann
+ * otherwise. Edges that cross the inside of the domain between two
+ * boundary nodes get no condition.
+ *
+ * The Neumann value is a load on each node, not a flux per area, and a
+ * boundary face is split in 4, so the Neumann nodes of a face become about
+ * 4 times as many. The fine mesh gets a quarter of NEUMANN_VALUE, which
+ * keeps the total load on the boundary.
+ */
+#include <climits>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Corners of each edge of a tetrahedron, midpoints of a refined
+ * element are numbered 4 + edge
+ */
+static const int tetrahedron_edges[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+
+/**
+ * @brief Corners of each face, face f is opposite to corner f
+ */
+static const int tetrahedron_faces[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+
+/**
+ * @brief Corner children of a refined element, in the 10 nodes numbering
+ * (corners 0 ... 3, midpoints 4 ... 9)
+ */
+static const int corner_children[4][4] = {{0, 4, 5, 6}, {4, 1, 7, 8}, {5, 7, 2, 9}, {6, 8, 9, 3}};
+
+/**
+ * @brief Diagonals of the inner octahedron, with the other 4 midpoints in
+ * order around each one
+ */
+static const int octahedron_diagonals[3][6] = {{4, 9, 5, 6, 8, 7}, {5, 8, 4, 6, 9, 7}, {6, 7, 4, 5, 9, 8}};
+
+/**
+ * @brief Edge -> slot hash table, safe to fill from several threads
+ *
+ * Keys are (a << 32) | b with a < b, so 0 (edge 0 - 0) marks an empty slot.
+ * owner[slot] is the smallest 6 * element + edge that inserted the key.
+ */
+class EdgeTable
+{
+private:
+    unsigned long long *keys;
+    int *owner;
+    long long capacity; // power of 2, at least twice the edges
+    int bits;
+
+    long long home(unsigned long long key)
+    {
+        return (long long)((key * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+    }
+
+public:
+    int *node; // midpoint node index of each slot, filled by the caller
+
+    EdgeTable(long long edges)
+    {
+        bits = 1;
+        while ((1LL << bits) < 2 * edges)
+            bits++;
+        capacity = 1LL << bits;
+        keys = (unsigned long long *)calloc(capacity, sizeof(unsigned long long));
+        owner = (int *)malloc(sizeof(int) * capacity);
+        node = (int *)malloc(sizeof(int) * capacity);
+        if (keys == NULL || owner == NULL || node == NULL)
+            throw runtime_error("Not enough memory for the edge table of " + to_string(edges) + " edges");
+
+        #pragma omp parallel for
+        for (long long s = 0; s < capacity; s++)
+            owner[s] = INT_MAX;
+    }
+
+    ~EdgeTable()
+    {
+        free(keys);
+        free(owner);
+        free(node);
+    }
+
+    static unsigned long long edge_key(int a, int b)
+    {
+        return a < b ? ((unsigned long long)a << 32) | (unsigned)b : ((unsigned long long)b << 32) | (unsigned)a;
+    }
+
+    /**
+     * @brief Inserts the edge if it is new and returns its slot
+     */
+    long long insert(unsigned long long key, int owner_code)
+    {
+        long long slot = home(key);
+        while (true)
+        {
+            unsigned long long found = __sync_val_compare_and_swap(&keys[slot], 0ULL, key);
+            if (found == 0 || found == key)
+                break;
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        int current = owner[slot];
+        while (owner_code < current)
+        {
+            int previous = __sync_val_compare_and_swap(&owner[slot], current, owner_code);
+            if (previous == current)
+                break;
+            current = previous;
+        }
+        return slot;
+    }
+
+    int get_owner(long long slot)
+    {
+        return owner[slot];
+    }
+};
+
+/**
+ * @brief Six times the signed volume of the tetrahedron a, b, c, d
+ */
+double signed_volume6(float *x, float *y, float *z, int a, int b, int c, int d)
+{
+    double u[3] = {(double)x[b] - x[a], (double)y[b] - y[a], (double)z[b] - z[a]};
+    double v[3] = {(double)x[c] - x[a], (double)y[c] - y[a], (double)z[c] - z[a]};
+    double w[3] = {(double)x[d] - x[a], (double)y[d] - y[a], (double)z[d] - z[a]};
+    return u[0] * (v[1] * w[2] - v[2] * w[1]) - u[1] * (v[0] * w[2] - v[2] * w[0]) + u[2] * (v[0] * w[1] - v[1] * w[0]);
+}
+
+/**
+ * @brief Number of elements that contain the nodes a, b and c, from the
+ * sorted rows of the node -> element graph
+ */
+int count_common_elements(MeshGraph *graph, int a, int b, int c)
+{
+    int *offset = graph->get_element_offsets();
+    int *index = graph->get_element_indices();
+    int pb = offset[b], pc = offset[c];
+    int count = 0;
+    for (int pa = offset[a]; pa < offset[a + 1]; pa++)
+    {
+        int e = index[pa];
+        while (pb < offset[b + 1] && index[pb] < e)
+            pb++;
+        while (pc < offset[c + 1] && index[pc] < e)
+            pc++;
+        if (pb < offset[b + 1] && index[pb] == e && pc < offset[c + 1] && index[pc] == e)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Fills fine with the 1:8 refinement of coarse, throws if the result
+ * does not fit the 32 bit indices of Mesh
+ *
+ * Builds the graphs of coarse if it has none. Old nodes keep their index
+ * and file ID, new nodes get the IDs after the largest one.
+ */
+void refine_mesh(Mesh *coarse, Mesh *fine)
+{
+    int num_nodes = coarse->get_quantity(NUM_NODES);
+    int num_elements = coarse->get_quantity(NUM_ELEMENTS);
+    int num_dirichlet = coarse->get_quantity(NUM_DIRICHLET);
+    int num_neumann = coarse->get_quantity(NUM_NEUMANN);
+
+    MeshGraph *graph = coarse->get_graph();
+    long long num_edges = graph->get_num_edges();
+    long long fine_nodes = num_nodes + num_edges;
+    long long fine_elements = 8LL * num_elements;
+    if (fine_nodes > INT_MAX || fine_elements > INT_MAX / 4)
+        throw runtime_error("Refining " + to_string(num_elements) + " elements gives " + to_string(fine_nodes) +
+                            " nodes and " + to_string(fine_elements) + " elements, more than the 32 bit indices of the mesh");
+
+    float *x = coarse->get_x_coordinates(), *y = coarse->get_y_coordinates(), *z = coarse->get_z_coordinates();
+    int *connectivity = coarse->get_connectivity();
+
+    // Unique edges, slot of each edge of each element
+    EdgeTable table(num_edges);
+    long long *element_slots = (long long *)malloc(sizeof(long long) * 6 * num_elements);
+    int *new_before = (int *)malloc(sizeof(int) * (num_elements + 1)); // new nodes of the elements before e
+    if (element_slots == NULL || new_before == NULL)
+        throw runtime_error("Not enough memory to refine " + to_string(num_elements) + " elements");
+
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+        for (int l = 0; l < 6; l++)
+        {
+            int a = connectivity[4 * e + tetrahedron_edges[l][0]], b = connectivity[4 * e + tetrahedron_edges[l][1]];
+            element_slots[6 * e + l] = table.insert(EdgeTable::edge_key(a, b), 6 * e + l);
+        }
+
+    // Midpoints are numbered by their owner, the first element of the edge
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+    {
+        int owned = 0;
+        for (int l = 0; l < 6; l++)
+            if (table.get_owner(element_slots[6 * e + l]) == 6 * e + l)
+                owned++;
+        new_before[e + 1] = owned;
+    }
+    new_before[0] = 0;
+    for (int e = 0; e < num_elements; e++)
+        new_before[e + 1] += new_before[e];
+
+    // Conditions of the old nodes and of the boundary faces
+    char *node_condition = (char *)calloc(num_nodes, 1); // 1 Dirichlet, 2 Neumann
+    char *edge_condition = (char *)calloc(6LL * num_elements, 1); // by owner code
+    int *dirichlet_nodes = coarse->get_dirichlet_nodes();
+    int *neumann_nodes = coarse->get_neumann_nodes();
+    for (int i = 0; i < num_dirichlet; i++)
+        node_condition[dirichlet_nodes[i]] |= 1;
+    for (int i = 0; i < num_neumann; i++)
+        node_condition[neumann_nodes[i]] |= 2;
+
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+    {
+        int *n = &connectivity[4 * e];
+        for (int f = 0; f < 4; f++)
+        {
+            int a = n[tetrahedron_faces[f][0]], b = n[tetrahedron_faces[f][1]], c = n[tetrahedron_faces[f][2]];
+            if (!node_condition[a] || !node_condition[b] || !node_condition[c] || count_common_elements(graph, a, b, c) != 1)
+                continue;
+
+            char face_condition = (node_condition[a] & node_condition[b] & node_condition[c] & 1) ? 1 : 2;
+            for (int l = 0; l < 6; l++)
+                if (tetrahedron_edges[l][0] != f && tetrahedron_edges[l][1] != f)
+                {
+                    int code = table.get_owner(element_slots[6 * e + l]);
+                    #pragma omp atomic
+                    edge_condition[code] |= face_condition;
+                }
+        }
+    }
+
+    int num_new = new_before[num_elements];
+    int fine_dirichlet = num_dirichlet, fine_neumann = num_neumann;
+    for (int e = 0; e < num_elements; e++)
+        for (int l = 0; l < 6; l++)
+        {
+            char condition = edge_condition[6 * e + l];
+            if (condition & 1)
+                fine_dirichlet++;
+            else if (condition & 2)
+                fine_neumann++;
+        }
+
+    fine->set_problem_data(coarse->get_problem_data(THERMAL_CONDUCTIVITY), coarse->get_problem_data(HEAT_SOURCE));
+    fine->set_boundary_values(coarse->get_problem_data(DIRICHLET_VALUE), coarse->get_problem_data(NEUMANN_VALUE) / 4);
+    fine->set_quantities(num_nodes + num_new, (int)fine_elements, fine_dirichlet, fine_neumann);
+    fine->init_arrays();
+
+    IdMap *coarse_ids = coarse->get_node_ids();
+    if (coarse_ids->is_identity())
+        fine->get_node_ids()->build_identity(num_nodes + num_new);
+    else
+    {
+        long long *ids = (long long *)malloc(sizeof(long long) * (num_nodes + num_new));
+        long long next_id = coarse_ids->to_id(num_nodes - 1) + 1; // IDs are ascending
+        for (int i = 0; i < num_nodes; i++)
+            ids[i] = coarse_ids->to_id(i);
+        for (int i = 0; i < num_new; i++)
+            ids[num_nodes + i] = next_id + i;
+        fine->get_node_ids()->build(ids, num_nodes + num_new);
+        free(ids);
+    }
+
+    float *fine_x = fine->get_x_coordinates(), *fine_y = fine->get_y_coordinates(), *fine_z = fine->get_z_coordinates();
+    int *fine_connectivity = fine->get_connectivity();
+    int *fine_element_ids = fine->get_element_ids();
+
+    #pragma omp parallel for
+    for (int i = 0; i < num_nodes; i++)
+    {
+        fine_x[i] = x[i];
+        fine_y[i] = y[i];
+        fine_z[i] = z[i];
+    }
+
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+    {
+        int next = num_nodes + new_before[e];
+        for (int l = 0; l < 6; l++)
+        {
+            long long slot = element_slots[6 * e + l];
+            if (table.get_owner(slot) != 6 * e + l)
+                continue;
+            int a = connectivity[4 * e + tetrahedron_edges[l][0]], b = connectivity[4 * e + tetrahedron_edges[l][1]];
+            table.node[slot] = next;
+            fine_x[next] = (float)(((double)x[a] + x[b]) / 2);
+            fine_y[next] = (float)(((double)y[a] + y[b]) / 2);
+            fine_z[next] = (float)(((double)z[a] + z[b]) / 2);
+            next++;
+        }
+    }
+
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+    {
+        int local[10];
+        for (int v = 0; v < 4; v++)
+            local[v] = connectivity[4 * e + v];
+        for (int l = 0; l < 6; l++)
+            local[4 + l] = table.node[element_slots[6 * e + l]];
+
+        // Shortest diagonal of the octahedron
+        int diagonal = 0;
+        double shortest = -1;
+        for (int d = 0; d < 3; d++)
+        {
+            int p = local[octahedron_diagonals[d][0]], q = local[octahedron_diagonals[d][1]];
+            double dx = (double)fine_x[p] - fine_x[q], dy = (double)fine_y[p] - fine_y[q], dz = (double)fine_z[p] - fine_z[q];
+            double length = dx * dx + dy * dy + dz * dz;
+            if (shortest < 0 || length < shortest)
+            {
+                shortest = length;
+                diagonal = d;
+            }
+        }
+
+        int children[8][4];
+        for (int c = 0; c < 4; c++)
+            for (int v = 0; v < 4; v++)
+                children[c][v] = local[corner_children[c][v]];
+        const int *octahedron = octahedron_diagonals[diagonal];
+        for (int c = 0; c < 4; c++)
+        {
+            children[4 + c][0] = local[octahedron[0]];
+            children[4 + c][1] = local[octahedron[1]];
+            children[4 + c][2] = local[octahedron[2 + c]];
+            children[4 + c][3] = local[octahedron[2 + (c + 1) % 4]];
+        }
+
+        bool positive = signed_volume6(x, y, z, local[0], local[1], local[2], local[3]) >= 0;
+        for (int c = 0; c < 8; c++)
+        {
+            int *child = &fine_connectivity[4 * (8LL * e + c)];
+            for (int v = 0; v < 4; v++)
+                child[v] = children[c][v];
+            if ((signed_volume6(fine_x, fine_y, fine_z, child[0], child[1], child[2], child[3]) >= 0) != positive)
+                swap(child[2], child[3]);
+            fine_element_ids[8 * e + c] = 8 * e + c + 1;
+        }
+    }
+
+    // Old conditions first, then the midpoints in ascending order
+    int *fine_dirichlet_nodes = fine->get_dirichlet_nodes();
+    int *fine_neumann_nodes = fine->get_neumann_nodes();
+    for (int i = 0; i < num_dirichlet; i++)
+        fine_dirichlet_nodes[i] = dirichlet_nodes[i];
+    for (int i = 0; i < num_neumann; i++)
+        fine_neumann_nodes[i] = neumann_nodes[i];
+    int d = num_dirichlet, m = num_neumann;
+    for (int e = 0; e < num_elements; e++)
+        for (int l = 0; l < 6; l++)
+        {
+            char condition = edge_condition[6 * e + l];
+            if (condition & 1)
+                fine_dirichlet_nodes[d++] = table.node[element_slots[6 * e + l]];
+            else if (condition & 2)
+                fine_neumann_nodes[m++] = table.node[element_slots[6 * e + l]];
+        }
+
+    free(element_slots);
+    free(new_before);
+    free(node_condition);
+    free(edge_condition);
+
+    fine->build_entities();
+}
@@ -0,0 +1,290 @@
+/**
+ * @file geometry/node_store.hpp
+ *
+ * @brief Node storage chosen at compile time
+ *
+ * The project copies used to differ only in how nodes are kept: a plain
+ * Node** array here and in SEGUNDA ECUACION, a MinHeap in MONTICULOS MINIMOS.
+ * NodeStore gives all of them the same interface and takes the actual storage
+ * as a template policy:
+ *
+ *  - ArrayNodeStorage: Node** indexed by ID - 1, needs IDs 1 ... n
+ *  - HeapNodeStorage: MinHeap ordered by ID with its ID -> slot index
+ *  - HashNodeStorage: open addressing hash table keyed by ID, any IDs
+ *
+ * Every policy provides
+ *
+ *  - init(capacity): allocates room for capacity nodes
+ *  - insert(node)
+ *  - build(pool, n): stores the n nodes of a contiguous block at once
+ *  - find(id): node with that ID, NULL if it is not stored
+ *  - at(i): i-th stored node, 0 <= i < size(), in the storage own order
+ *  - size()
+ *  - bytes_for(capacity): memory init(capacity) allocates, for --dry-run
+ *
+ * Mesh uses NodeStore<NODE_STORAGE>, compile with e.g.
+ * -DNODE_STORAGE=HashNodeStorage to switch. See node_store_benchmark.cpp
+ * to compare them on a mesh.
+ */
+#include "heap.hpp"
+
+class ArrayNodeStorage
+{
+private:
+    Node **nodes;
+    int capacity;
+    int count;
+
+public:
+    ArrayNodeStorage()
+    {
+        nodes = NULL;
+        capacity = 0;
+        count = 0;
+    }
+
+    ~ArrayNodeStorage()
+    {
+        free(nodes);
+    }
+
+    void init(int node_capacity)
+    {
+        capacity = node_capacity;
+        nodes = (Node **)calloc(capacity, sizeof(Node *));
+    }
+
+    void insert(Node *node)
+    {
+        nodes[node->get_ID() - 1] = node;
+        count++;
+    }
+
+    void build(Node *pool, int n)
+    {
+        for (int i = 0; i < n; i++)
+            insert(&pool[i]);
+    }
+
+    Node *find(int id)
+    {
+        if (id < 1 || id > capacity)
+            return NULL;
+        return nodes[id - 1];
+    }
+
+    Node *at(int i)
+    {
+        return nodes[i];
+    }
+
+    static long long bytes_for(int node_capacity)
+    {
+        return (long long)sizeof(Node *) * node_capacity;
+    }
+
+    int size()
+    {
+        return count;
+    }
+};
+
+class HeapNodeStorage
+{
+private:
+    MinHeap *heap;
+
+public:
+    HeapNodeStorage()
+    {
+        heap = NULL;
+    }
+
+    ~HeapNodeStorage()
+    {
+        delete heap;
+    }
+
+    void init(int node_capacity)
+    {
+        heap = new MinHeap(node_capacity);
+    }
+
+    void insert(Node *node)
+    {
+        heap->insert(node);
+    }
+
+    /**
+     * @brief One O(n) heapify instead of n inserts, see MinHeap::build()
+     */
+    void build(Node *pool, int n)
+    {
+        Node **list = (Node **)malloc(sizeof(Node *) * (n > 0 ? n : 1));
+        for (int i = 0; i < n; i++)
+            list[i] = &pool[i];
+        heap->build(list, n);
+        free(list);
+    }
+
+    Node *find(int id)
+    {
+        return heap->getNodeById(id - 1);
+    }
+
+    Node *at(int i)
+    {
+        return heap->at(i);
+    }
+
+    static long long bytes_for(int node_capacity)
+    {
+        return (long long)(sizeof(Node *) + sizeof(int)) * node_capacity + sizeof(MinHeap);
+    }
+
+    int size()
+    {
+        return heap->size();
+    }
+};
+
+/**
+ * @brief Linear probing table with a power of two number of slots, at least
+ * twice the capacity so the load factor stays under 1/2.
+ *
+ * The slot of an ID comes from Fibonacci hashing (multiply by 2^32 / phi and
+ * keep the high bits), which spreads consecutive IDs over the whole table.
+ */
+class HashNodeStorage
+{
+private:
+    Node **slots;  // table, NULL = empty slot
+    Node **nodes;  // stored nodes in insertion order, for at()
+    int num_slots; // power of two
+    int shift;     // 32 - log2(num_slots)
+    int count;
+
+    int home_slot(int id)
+    {
+        return (int)(((unsigned int)id * 2654435769u) >> shift);
+    }
+
+public:
+    HashNodeStorage()
+    {
+        slots = NULL;
+        nodes = NULL;
+        num_slots = 0;
+        shift = 32;
+        count = 0;
+    }
+
+    ~HashNodeStorage()
+    {
+        free(slots);
+        free(nodes);
+    }
+
+    void init(int node_capacity)
+    {
+        num_slots = 2;
+        shift = 31;
+        while (num_slots < 2 * node_capacity)
+        {
+            num_slots *= 2;
+            shift--;
+        }
+
+        slots = (Node **)calloc(num_slots, sizeof(Node *));
+        nodes = (Node **)malloc(sizeof(Node *) * node_capacity);
+    }
+
+    void insert(Node *node)
+    {
+        int s = home_slot(node->get_ID());
+        while (slots[s] != NULL)
+            s = (s + 1) & (num_slots - 1);
+
+        slots[s] = node;
+        nodes[count++] = node;
+    }
+
+    void build(Node *pool, int n)
+    {
+        for (int i = 0; i < n; i++)
+            insert(&pool[i]);
+    }
+
+    Node *find(int id)
+    {
+        int s = home_slot(id);
+        while (slots[s] != NULL)
+        {
+            if (slots[s]->get_ID() == id)
+                return slots[s];
+            s = (s + 1) & (num_slots - 1);
+        }
+        return NULL;
+    }
+
+    Node *at(int i)
+    {
+        return nodes[i];
+    }
+
+    static long long bytes_for(int node_capacity)
+    {
+        long long slots = 2;
+        while (slots < 2LL * node_capacity)
+            slots *= 2;
+        return (long long)sizeof(Node *) * (slots + node_capacity);
+    }
+
+    int size()
+    {
+        return count;
+    }
+};
+
+template <class Storage>
+class NodeStore
+{
+private:
+    Storage storage;
+
+public:
+    void init(int capacity)
+    {
+        storage.init(capacity);
+    }
+
+    void insert(Node *node)
+    {
+        storage.insert(node);
+    }
+
+    void build(Node *pool, int n)
+    {
+        storage.build(pool, n);
+    }
+
+    Node *find(int id)
+    {
+        return storage.find(id);
+    }
+
+    Node *at(int i)
+    {
+        return storage.at(i);
+    }
+
+    static long long bytes_for(int capacity)
+    {
+        return Storage::bytes_for(capacity);
+    }
+
+    int size()
+    {
+        return storage.size();
+    }
+};
@@ -0,0 +1,239 @@
+/**
+ * @file gid/dat_parser.hpp
+ *
+ * @brief Tokenizer for the .dat files written by heat3d.bas, also used
+ * for the text files of a GiD project
+ *
+ * Works on the whole file in memory (see mapped_file.hpp, included by
+ * geometry/mesh.hpp) instead of an ifstream:
+ *
+ *  - Numbers are converted with std::from_chars, which does not depend on
+ *    the locale and does not copy the token
+ *  - Whitespace runs (the column padding of GiD) are skipped 16 bytes at a
+ *    time with SSE2 when the compiler targets it, byte by byte otherwise
+ *  - Every error reports the file, line and column of the offending token
+ */
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+class DatScanner
+{
+private:
+    const char *begin;
+    const char *end;
+    const char *cursor;
+    string filename;
+
+    static bool is_space(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    /**
+     * @brief Fails unless the token that starts at token ends at next
+     */
+    void check_token_end(const char *token, const char *next, const char *what)
+    {
+        if (next < end && !is_space(*next))
+            fail(token, string("expected ") + what);
+    }
+
+public:
+    DatScanner(const char *data, size_t size, string name)
+    {
+        begin = data;
+        end = data + size;
+        cursor = data;
+        filename = name;
+    }
+
+    /**
+     * @brief Scanner over [from, to), a part of the same file
+     *
+     * Line and column numbers of its errors still count from the start of the file.
+     */
+    DatScanner range(const char *from, const char *to)
+    {
+        DatScanner part = *this;
+        part.cursor = from;
+        part.end = to;
+        return part;
+    }
+
+    const char *get_cursor()
+    {
+        return cursor;
+    }
+
+    void set_cursor(const char *position)
+    {
+        cursor = position;
+    }
+
+    bool at_end()
+    {
+        return cursor >= end;
+    }
+
+    /**
+     * @brief Position of the next keyword that stands as a whole token, from the cursor
+     *
+     * @return NULL if there is none
+     */
+    const char *find_keyword(const char *keyword)
+    {
+        size_t length = strlen(keyword);
+        const char *p = cursor;
+        while ((size_t)(end - p) >= length)
+        {
+            p = (const char *)memchr(p, keyword[0], end - p - length + 1);
+            if (p == NULL)
+                return NULL;
+            if (memcmp(p, keyword, length) == 0 && (p == begin || is_space(p[-1])) &&
+                (p + length == end || is_space(p[length])))
+                return p;
+            p++;
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief Advances to the next non whitespace character, or the end of the file
+     */
+    void skip_whitespace()
+    {
+        if (cursor < end && !is_space(*cursor))
+            return;
+
+#ifdef __SSE2__
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriage = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+
+        while (end - cursor >= 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *)cursor);
+            __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, newline)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(block, carriage), _mm_cmpeq_epi8(block, tab)));
+            unsigned int token = ~(unsigned int)_mm_movemask_epi8(blank) & 0xFFFF;
+            if (token != 0)
+            {
+                cursor += __builtin_ctz(token);
+                return;
+            }
+            cursor += 16;
+        }
+#endif
+        while (cursor < end && is_space(*cursor))
+            cursor++;
+    }
+
+    /**
+     * @brief Throws "file:line:column: message", position is a pointer into the file
+     */
+    [[noreturn]] void fail(const char *position, string message)
+    {
+        long long line = 1;
+        const char *line_start = begin;
+        for (const char *p = begin; p < position; p++)
+            if (*p == '\n')
+            {
+                line++;
+                line_start = p + 1;
+            }
+
+        string found;
+        if (position >= end)
+            found = "end of file";
+        else
+        {
+            const char *token_end = position;
+            while (token_end < end && !is_space(*token_end) && token_end - position < 32)
+                token_end++;
+            found = "'" + string(position, token_end) + "'";
+        }
+
+        throw runtime_error(filename + ":" + to_string(line) + ":" + to_string(position - line_start + 1) + ": " +
+                            message + ", found " + found);
+    }
+
+    long long read_integer(const char *what)
+    {
+        skip_whitespace();
+        const char *token = cursor;
+        const char *digits = (token < end && *token == '+') ? token + 1 : token;
+
+        long long value;
+        from_chars_result result = from_chars(digits, end, value);
+        if (result.ec == errc::result_out_of_range)
+            fail(token, string(what) + " out of range");
+        if (result.ec != errc())
+            fail(token, string("expected ") + what);
+        check_token_end(token, result.ptr, what);
+
+        cursor = result.ptr;
+        return value;
+    }
+
+    /**
+     * @brief Integer that must fit an int and be at least minimum
+     */
+    int read_int(const char *what, int minimum = INT_MIN)
+    {
+        skip_whitespace();
+        const char *token = cursor;
+        long long value = read_integer(what);
+        if (value < minimum || value > INT_MAX)
+            fail(token, string(what) + " out of range");
+        return (int)value;
+    }
+
+    float read_float(const char *what)
+    {
+        skip_whitespace();
+        const char *token = cursor;
+        const char *digits = (token < end && *token == '+') ? token + 1 : token;
+
+        float value;
+        from_chars_result result = from_chars(digits, end, value);
+        if (result.ec == errc::result_out_of_range)
+            fail(token, string(what) + " out of the range of float");
+        if (result.ec != errc())
+            fail(token, string("expected ") + what);
+        check_token_end(token, result.ptr, what);
+
+        cursor = result.ptr;
+        return value;
+    }
+
+    /**
+     * @brief Next whitespace delimited token, empty at the end of the file
+     */
+    string read_word()
+    {
+        skip_whitespace();
+        const char *token = cursor;
+        while (cursor < end && !is_space(*cursor))
+            cursor++;
+        return string(token, cursor);
+    }
+
+    /**
+     * @brief Consumes a section marker such as Coordinates or EndElements
+     */
+    void expect(const char *keyword)
+    {
+        skip_whitespace();
+        size_t length = strlen(keyword);
+        if ((size_t)(end - cursor) < length || memcmp(cursor, keyword, length) != 0)
+            fail(cursor, string("expected ") + keyword);
+        check_token_end(cursor, cursor + length, keyword);
+        cursor += length;
+    }
+};
@@ -0,0 +1,271 @@
+/**
+ * @file gid/gid_project.hpp
+ *
+ * @brief Reads a GiD project folder (NAME.gid) directly, without the .dat
+ * that heat3d.bas writes
+ *
+ *  - NAME.msh: binary mesh set, nodes and tetrahedra
+ *  - NAME.prb: problem data, k, Q, Dirichlet_Value and Neumann_Value
+ *  - NAME.cnd: condition definitions, Dirichlet and Neumann must be over nodes
+ *
+ * GiD keeps the condition assignments on the geometry (NAME.geo), not on the
+ * mesh, and only resolves them to mesh nodes when it writes the calculation
+ * file. So the Dirichlet and Neumann node lists are taken from the first of
+ *
+ *  - NAME.conditions: a text file with the Dirichlet ... EndDirichlet and
+ *    Neumann ... EndNeumann sections of the .dat format
+ *  - NAME.dat: the calculation file of the last run of the problem type,
+ *    GiD leaves it in the project folder
+ *
+ * The .dat files of the MALLA_* projects were not kept, and their .geo only
+ * holds the assignments to GiD surfaces, so their .conditions were rebuilt
+ * from the heat3d results in RESULTADOS POSTPROCESOS:
+ *
+ *  - Dirichlet: the nodes at exactly Dirichlet_Value, the base of the pot
+ *  - Neumann: the nodes of the two handle end faces (y > 34.87) where
+ *    K T - b of those results is Neumann_Value
+ *
+ * Solving with them reproduces those results with a relative L2 error of
+ * 5.0e-5 (PEQ) and 9.5e-5 (MEDIANA, GRANDE), and a largest relative error
+ * of 1.2e-3 and 2.0e-3 next to the handle faces. The node sets may differ
+ * from the GiD assignments there. Since the conditions come from the same
+ * results, --check against RESULTADOS POSTPROCESOS shows that these inputs
+ * are consistent with them, it does not validate the solver.
+ *
+ * Binary layout of the mesh set, as written by GiD for a single tetrahedra
+ * mesh (little endian, offsets in bytes):
+ *
+    0     8 zero bytes, int32 16, "GID_MESHSET 1.2\0"
+    28    int32 number of nodes
+    32    node records, 56 bytes: int64 ID at 0, doubles x y z at 32
+    ...   int32 x 7: 0, 3, element type (4 = tetrahedra), nodes per element,
+          number of nodes, number of elements, 0
+    ...   element records, 48 bytes: int32 ID at 0, int32 node IDs at 32
+ *
+ * Anything after the elements is ignored.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define MSH_MAGIC "GID_MESHSET 1.2"
+#define MSH_NODES_OFFSET 32
+#define MSH_NODE_SIZE 56
+#define MSH_ELEMENT_HEADER_SIZE 28
+#define MSH_ELEMENT_SIZE 48
+#define MSH_TETRAHEDRA 4
+
+/**
+ * @brief True if path names a GiD project folder, path ends with .gid
+ */
+bool is_gid_project(string path){
+    while(path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+        path.pop_back();
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".gid") == 0;
+}
+
+/**
+ * @brief "dir/NAME.gid" -> "dir/NAME.gid/NAME", the prefix of the project files
+ */
+string gid_project_basename(string path){
+    while(path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+        path.pop_back();
+
+    size_t slash = path.find_last_of("/\\");
+    string folder = slash == string::npos ? path : path.substr(slash + 1);
+    return path + "/" + folder.substr(0, folder.size() - 4);
+}
+
+/**
+ * @brief Reads the four values of the heat3d problem data
+ */
+void read_problem_data(string filename, float* k, float* Q, float* T_bar, float* T_hat){
+    MappedFile prb_file;
+    prb_file.open(filename);
+    DatScanner prb(prb_file.get_data(), prb_file.get_size(), filename);
+
+    bool found[4] = {false, false, false, false};
+    const char* names[4] = {"k", "Q", "Dirichlet_Value", "Neumann_Value"};
+    float* values[4] = {k, Q, T_bar, T_hat};
+
+    while(!prb.at_end()){
+        if(prb.read_word() != "QUESTION:")
+            continue;
+
+        string question = prb.read_word();
+        for(int i = 0; i < 4; i++)
+            if(question == names[i]){
+                prb.expect("VALUE:");
+                *values[i] = prb.read_float(names[i]);
+                found[i] = true;
+            }
+        prb.skip_whitespace();
+    }
+
+    for(int i = 0; i < 4; i++)
+        if(!found[i])
+            throw runtime_error(filename + ": missing problem data " + names[i]);
+}
+
+/**
+ * @brief Checks that Dirichlet and Neumann are defined as conditions over nodes
+ */
+void check_condition_definitions(string filename){
+    MappedFile cnd_file;
+    cnd_file.open(filename);
+    DatScanner cnd(cnd_file.get_data(), cnd_file.get_size(), filename);
+
+    bool dirichlet = false, neumann = false;
+    string condition;
+
+    while(!cnd.at_end()){
+        string word = cnd.read_word();
+        if(word == "CONDITION:")
+            condition = cnd.read_word();
+        else if(word == "CONDMESHTYPE:"){
+            string mesh_type = cnd.read_word();
+            mesh_type += " " + cnd.read_word();
+            if(condition == "Dirichlet")
+                dirichlet = mesh_type == "over nodes";
+            if(condition == "Neumann")
+                neumann = mesh_type == "over nodes";
+        }
+        cnd.skip_whitespace();
+    }
+
+    if(!dirichlet || !neumann)
+        throw runtime_error(filename + ": Dirichlet and Neumann must be conditions over nodes");
+}
+
+/**
+ * @brief Node IDs listed between section and end_marker, anywhere in a text file
+ */
+vector<long long> read_condition_ids(MappedFile* file, string filename, const char* section, const char* end_marker){
+    DatScanner text(file->get_data(), file->get_size(), filename);
+
+    const char* start = text.find_keyword(section);
+    if(start == NULL)
+        throw runtime_error(filename + ": missing section " + section);
+    text.set_cursor(start);
+    text.expect(section);
+
+    const char* stop = text.find_keyword(end_marker);
+    if(stop == NULL)
+        text.fail(file->get_data() + file->get_size(), string("expected ") + end_marker);
+
+    // Counted first, so the IDs fit in a single allocation
+    DatScanner list = text.range(text.get_cursor(), stop);
+    int size = 0;
+    for(list.skip_whitespace(); !list.at_end(); list.skip_whitespace()){
+        list.read_integer("a node ID");
+        size++;
+    }
+
+    vector<long long> ids(size);
+    list = text.range(text.get_cursor(), stop);
+    for(int i = 0; i < size; i++)
+        ids[i] = list.read_integer("a node ID");
+    return ids;
+}
+
+/**
+ * @brief Copies a value of type T from an unaligned position of a binary file
+ */
+template <class T>
+T read_binary(const char* data, size_t offset){
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Reads a GiD project into M
+ *
+ * @param basename Prefix of the project files, see gid_project_basename()
+ */
+void read_gid_project(string basename, Mesh* M){
+    float k, Q, T_bar, T_hat;
+    read_problem_data(basename + ".prb", &k, &Q, &T_bar, &T_hat);
+    check_condition_definitions(basename + ".cnd");
+
+    string conditions_name = basename + ".conditions";
+    if(!file_exists(conditions_name))
+        conditions_name = basename + ".dat";
+    if(!file_exists(conditions_name))
+        throw runtime_error("The condition nodes of " + basename + " are not in the mesh, write them to " + basename +
+                            ".conditions or run heat3d once from GiD to create " + basename + ".dat");
+
+    MappedFile conditions_file;
+    conditions_file.open(conditions_name);
+    // vectors, so they are not leaked when a node ID or the .msh below is invalid
+    vector<long long> dirichlet_ids = read_condition_ids(&conditions_file, conditions_name, "Dirichlet", "EndDirichlet");
+    vector<long long> neumann_ids = read_condition_ids(&conditions_file, conditions_name, "Neumann", "EndNeumann");
+    int num_dirichlet = (int) dirichlet_ids.size(), num_neumann = (int) neumann_ids.size();
+
+    /**
+     * @brief Mesh set
+     */
+    string msh_name = basename + ".msh";
+    MappedFile msh_file;
+    msh_file.open(msh_name);
+    const char* msh = msh_file.get_data();
+    size_t size = msh_file.get_size();
+
+    if(size < MSH_NODES_OFFSET || memcmp(msh + 12, MSH_MAGIC, sizeof(MSH_MAGIC)) != 0)
+        throw runtime_error(msh_name + ": not a " + MSH_MAGIC + " file");
+
+    int num_nodes = read_binary<int>(msh, 28);
+    size_t header = MSH_NODES_OFFSET + (size_t) num_nodes * MSH_NODE_SIZE;
+    if(num_nodes < 0 || size < header + MSH_ELEMENT_HEADER_SIZE)
+        throw runtime_error(msh_name + ": truncated node records");
+
+    int element_type = read_binary<int>(msh, header + 8);
+    int nodes_per_element = read_binary<int>(msh, header + 12);
+    int num_elements = read_binary<int>(msh, header + 20);
+    if(element_type != MSH_TETRAHEDRA || nodes_per_element != 4 || read_binary<int>(msh, header + 16) != num_nodes)
+        throw runtime_error(msh_name + ": only meshes of 4 node tetrahedra are supported");
+
+    size_t elements_offset = header + MSH_ELEMENT_HEADER_SIZE;
+    if(num_elements < 0 || size < elements_offset + (size_t) num_elements * MSH_ELEMENT_SIZE)
+        throw runtime_error(msh_name + ": truncated element records");
+
+    M->set_problem_data(k, Q);
+    M->set_boundary_values(T_bar, T_hat);
+    M->set_quantities(num_nodes, num_elements, num_dirichlet, num_neumann);
+    M->init_arrays();
+
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+    vector<long long> ids(num_nodes);
+    for(int i = 0; i < num_nodes; i++){
+        size_t record = MSH_NODES_OFFSET + (size_t) i * MSH_NODE_SIZE;
+        ids[i] = read_binary<long long>(msh, record);
+        x[i] = (float) read_binary<double>(msh, record + 32);
+        y[i] = (float) read_binary<double>(msh, record + 40);
+        z[i] = (float) read_binary<double>(msh, record + 48);
+    }
+    number_nodes(M, ids.data());
+
+    IdMap* node_ids = M->get_node_ids();
+    int* connectivity = M->get_connectivity();
+    int* element_ids = M->get_element_ids();
+    for(int e = 0; e < num_elements; e++){
+        size_t record = elements_offset + (size_t) e * MSH_ELEMENT_SIZE;
+        element_ids[e] = read_binary<int>(msh, record);
+        for(int k = 0; k < 4; k++)
+            connectivity[4 * e + k] = node_ids->require_index(read_binary<int>(msh, record + 32 + 4 * k), "Elements");
+    }
+
+    int* dirichlet_nodes = M->get_dirichlet_nodes();
+    for(int i = 0; i < num_dirichlet; i++)
+        dirichlet_nodes[i] = node_ids->require_index(dirichlet_ids[i], "Dirichlet");
+
+    int* neumann_nodes = M->get_neumann_nodes();
+    for(int i = 0; i < num_neumann; i++)
+        neumann_nodes[i] = node_ids->require_index(neumann_ids[i], "Neumann");
+
+    num_dirichlet = sort_condition_nodes(dirichlet_nodes, num_dirichlet);
+    num_neumann = sort_condition_nodes(neumann_nodes, num_neumann);
+    M->set_quantities(num_nodes, num_elements, num_dirichlet, num_neumann);
+
+    M->build_entities();
+}
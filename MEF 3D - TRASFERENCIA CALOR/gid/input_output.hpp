@@ -33,95 +33,416 @@
     [nodes_with_nuemann_id]
     ...
     EndNeumann 
+
+ * The inputs of the second equation have no [k] [Q] line, see read_input().
+ *
+ * Node IDs don't need to be 1 ... n, they can have gaps or be any 64 bit
+ * value: nodes are renumbered with compact IDs (see geometry/id_map.hpp)
+ * and the original IDs are written back in the results file.
  */
 
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <algorithm>
 using namespace std;
 
-void read_input(string filename, Mesh* M){
-    string line;
-    float k, Q, T_bar, T_hat;
-    int num_nodes, num_elements, num_dirichlet, num_neumann;
-    ifstream dat_file(filename+".dat");
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-    dat_file >> k >> Q >> T_bar >> T_hat >> num_nodes >> num_elements >> num_dirichlet >> num_neumann;
-    
-    M->set_problem_data(k,Q);
-    M->set_quantities(num_nodes,num_elements,num_dirichlet,num_neumann);
+#include "dat_parser.hpp"
+#include "mesh_cache.hpp"
 
-    M->init_arrays();
+/**
+ * @brief Sections smaller than this are always parsed by a single thread
+ */
+#ifndef PARALLEL_PARSE_MIN_BYTES
+#define PARALLEL_PARSE_MIN_BYTES (1 << 20)
+#endif
 
-    // While reading there are lines that limit sections, such as Elements / Conditions / Nodes  
-    // So read that line, saving a temp variable, in order to skip the lines 
-    dat_file >> line;
+/**
+ * @brief Reads a node ID and returns its compact index
+ *
+ * @param section Section of the input file, for the error message
+ */
+int read_node_reference(DatScanner* dat, IdMap* node_ids, const char* section){
+    dat->skip_whitespace();
+    const char* token = dat->get_cursor();
+    long long id = dat->read_integer("a node ID");
 
+    int index = node_ids->to_index(id);
+    if(index == -1)
+        dat->fail(token, string(section) + " references node ID " + to_string(id) + ", missing in Coordinates");
+    return index;
+}
 
-    /**
-     * @brief Read node list
-     * 
-     */
-    for(int i = 0; i < num_nodes; i++){
-        int id;
-        float x, y, z;
-        dat_file >> id >> x >> y >> z;
+/**
+ * @brief Sorts condition nodes by compact index and drops repeated ones
+ *
+ * The dense solvers remove the Dirichlet rows in ascending order (see
+ * apply_dirichlet_boundary_conditions() and merge_results_with_dirichlet()),
+ * so the lists must not keep the order of the file.
+ *
+ * @return Number of distinct nodes, now at the start of nodes
+ */
+int sort_condition_nodes(int* nodes, int count){
+    sort(nodes, nodes + count);
+    return (int) (unique(nodes, nodes + count) - nodes);
+}
 
-        M->insert_node(new Node(id,x,y, z), i);
+/**
+ * @brief Number of chunks a section is parsed in, 1 = serial
+ */
+int parse_chunks(const char* start, const char* stop){
+#ifdef _OPENMP
+    if(stop - start >= PARALLEL_PARSE_MIN_BYTES)
+        return omp_get_max_threads();
+#endif
+    return 1;
+}
 
+/**
+ * @brief Splits [start, stop) in at most parts pieces of similar size that begin at a line start
+ *
+ * @param bounds Output, piece p is [bounds[p], bounds[p + 1])
+ * @return Number of pieces
+ */
+int split_in_lines(const char* start, const char* stop, int parts, const char** bounds){
+    bounds[0] = start;
+    int count = 1;
+    for(int p = 1; p < parts; p++){
+        const char* cut = start + (stop - start) / parts * p;
+        if(cut < bounds[count - 1])
+            cut = bounds[count - 1];
+
+        const char* newline = (const char*) memchr(cut, '\n', stop - cut);
+        if(newline == NULL)
+            break;
+        if(newline + 1 > bounds[count - 1] && newline + 1 < stop)
+            bounds[count++] = newline + 1;
     }
+    bounds[count] = stop;
+    return count;
+}
 
-     /**
-     * @brief Read element list
-     * 
-     * Skip section limit lines and read element´s nodes and id
-     */
-    dat_file >> line >> line;
-    cout << "num_elements " << num_elements<< "\n";
-    for(int i = 0; i < num_elements; i++){
+/**
+ * @brief True if every slot of seen was written exactly once by the chunks
+ */
+bool all_seen(char* seen, int count, long long records){
+    if(records != count)
+        return false;
+    for(int i = 0; i < count; i++)
+        if(!seen[i])
+            return false;
+    return true;
+}
+
+/**
+ * @brief Parallel parse of the Coordinates section, [cursor of dat, stop)
+ *
+ * Every chunk writes node ID i at position i - 1, which is only valid when
+ * the IDs are exactly 1 ... n. Any other ID, a repeated or missing one, or a
+ * syntax error makes it return false, and the caller parses the section
+ * again serially, which handles the general case and reports the error.
+ */
+bool read_coordinates_in_chunks(DatScanner* dat, Mesh* M, const char* stop, int parts){
+    int num_nodes = M->get_quantity(NUM_NODES);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+
+    const char** bounds = (const char**) malloc(sizeof(const char*) * (parts + 1));
+    parts = split_in_lines(dat->get_cursor(), stop, parts, bounds);
+    char* seen = (char*) calloc(num_nodes, sizeof(char));
+
+    bool positional = true;
+    long long records = 0;
 
-        /**
-         * @name 3D MEF CHANGE 
-         * 
-         * Reading and Adding 4th node from input file to Mesh  
-         */
-        int id, node1_id, node2_id, node3_id, node4_id;
+    #pragma omp parallel for schedule(static, 1) reduction(&& : positional) reduction(+ : records)
+    for(int p = 0; p < parts; p++){
+        DatScanner chunk = dat->range(bounds[p], bounds[p + 1]);
+        try{
+            chunk.skip_whitespace();
+            while(!chunk.at_end()){
+                long long id = chunk.read_integer("a node ID");
+                if(id < 1 || id > num_nodes){
+                    positional = false;
+                    break;
+                }
+                x[id - 1] = chunk.read_float("the x coordinate");
+                y[id - 1] = chunk.read_float("the y coordinate");
+                z[id - 1] = chunk.read_float("the z coordinate");
 
-        dat_file >> id >> node1_id >> node2_id >> node3_id >> node4_id ;
-        
-        M->insert_element(new Element(id, M->get_node(node1_id-1), M->get_node(node2_id-1), M->get_node(node3_id-1), M->get_node(node4_id-1)), i);
+                #pragma omp atomic write
+                seen[id - 1] = 1;
+
+                records++;
+                chunk.skip_whitespace();
+            }
+        }
+        catch(const exception&){
+            positional = false;
+        }
     }
 
+    bool done = positional && all_seen(seen, num_nodes, records);
+    if(done)
+        M->get_node_ids()->build_identity(num_nodes);
 
-     /**
-     * @brief Read conditions list
-     * 
-     * Skip section limit lines and read nodes with dirichlet conditions 
-     */
-    dat_file >> line >> line;
+    free(bounds);
+    free(seen);
+    return done;
+}
+
+/**
+ * @brief Builds the compact numbering of nodes stored in file order
+ *
+ * x, y, z of the mesh hold node i of the file at position i, ids[i] is its
+ * file ID. Afterwards every node is at its compact index.
+ */
+void number_nodes(Mesh* M, long long* ids){
+    int num_nodes = M->get_quantity(NUM_NODES);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+
+    IdMap *node_ids = M->get_node_ids();
+    node_ids->build(ids, num_nodes);
 
-    for(int i = 0; i < num_dirichlet; i++){
-       int id;
-        dat_file >> id;
-        M->insert_dirichlet_condition(new Condition(M->get_node(id-1), T_bar), i);
+    // IDs 1 ... n in another order are an identity map, but still have to be moved
+    bool positional = true;
+    for(int i = 0; i < num_nodes && positional; i++)
+        positional = ids[i] == i + 1;
+
+    if(!positional){
+        float *file_order = (float *)malloc(sizeof(float) * 3 * num_nodes);
+        memcpy(file_order, x, sizeof(float) * num_nodes);
+        memcpy(file_order + num_nodes, y, sizeof(float) * num_nodes);
+        memcpy(file_order + 2 * num_nodes, z, sizeof(float) * num_nodes);
+
+        for(int i = 0; i < num_nodes; i++){
+            int index = node_ids->to_index(ids[i]);
+            x[index] = file_order[i];
+            y[index] = file_order[num_nodes + i];
+            z[index] = file_order[2 * num_nodes + i];
+        }
+        free(file_order);
+    }
+}
+
+/**
+ * @brief Reads the Coordinates section into the coordinate arrays of the mesh
+ * and builds the compact numbering
+ *
+ * Large sections are parsed in chunks when OpenMP is enabled, see
+ * read_coordinates_in_chunks()
+ */
+void read_coordinates(DatScanner* dat, Mesh* M){
+    int num_nodes = M->get_quantity(NUM_NODES);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+
+    dat->expect("Coordinates");
+
+    const char* section = dat->get_cursor();
+    const char* stop = dat->find_keyword("EndCoordinates");
+    int parts = stop == NULL ? 1 : parse_chunks(section, stop);
+    if(parts > 1 && read_coordinates_in_chunks(dat, M, stop, parts)){
+        dat->set_cursor(stop);
+        dat->expect("EndCoordinates");
+        return;
+    }
+    dat->set_cursor(section);
+
+    long long *ids = (long long *)malloc(sizeof(long long) * num_nodes);
+
+    // Stored in file order, that already is the compact order when the IDs are 1 ... n
+    bool positional = true;
+    for(int i = 0; i < num_nodes; i++){
+        ids[i] = dat->read_integer("a node ID");
+        x[i] = dat->read_float("the x coordinate");
+        y[i] = dat->read_float("the y coordinate");
+        z[i] = dat->read_float("the z coordinate");
+        positional = positional && ids[i] == i + 1;
+    }
+
+    dat->expect("EndCoordinates");
+
+    if(positional)
+        M->get_node_ids()->build_identity(num_nodes);
+    else
+        number_nodes(M, ids);
+
+    free(ids);
+}
+
+/**
+ * @brief Parallel parse of the Elements section, [cursor of dat, stop)
+ *
+ * Same scheme as read_coordinates_in_chunks(), but elements keep the file
+ * order, as in the serial parse: element ID e is stored at position e - 1,
+ * so it requires the IDs 1 ... num_elements in ascending order. Each chunk
+ * must hold consecutive IDs and start after the last ID of the one before.
+ */
+bool read_elements_in_chunks(DatScanner* dat, Mesh* M, const char* stop, int parts){
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int *connectivity = M->get_connectivity();
+    int *element_ids = M->get_element_ids();
+    IdMap *node_ids = M->get_node_ids();
+
+    const char** bounds = (const char**) malloc(sizeof(const char*) * (parts + 1));
+    parts = split_in_lines(dat->get_cursor(), stop, parts, bounds);
+    long long* first_id = (long long*) calloc(parts, sizeof(long long));
+    long long* chunk_records = (long long*) calloc(parts, sizeof(long long));
+
+    bool positional = true;
+
+    #pragma omp parallel for schedule(static, 1) reduction(&& : positional)
+    for(int p = 0; p < parts; p++){
+        DatScanner chunk = dat->range(bounds[p], bounds[p + 1]);
+        try{
+            chunk.skip_whitespace();
+            while(!chunk.at_end() && positional){
+                long long id = chunk.read_integer("an element ID");
+                if(chunk_records[p] == 0)
+                    first_id[p] = id;
+                if(id < 1 || id > num_elements || id != first_id[p] + chunk_records[p]){
+                    positional = false;
+                    break;
+                }
+                for(int k = 0; k < 4; k++){
+                    int index = node_ids->to_index(chunk.read_integer("a node ID"));
+                    if(index == -1)
+                        positional = false;
+                    connectivity[4 * (id - 1) + k] = index;
+                }
+                element_ids[id - 1] = (int) id;
+
+                chunk_records[p]++;
+                chunk.skip_whitespace();
+            }
+        }
+        catch(const exception&){
+            positional = false;
+        }
     }
 
-    dat_file >> line >> line;
+    long long records = 0;
+    for(int p = 0; p < parts && positional; p++){
+        positional = chunk_records[p] == 0 || first_id[p] == records + 1;
+        records += chunk_records[p];
+    }
+    bool done = positional && records == num_elements;
+
+    free(bounds);
+    free(first_id);
+    free(chunk_records);
+    return done;
+}
+
+/**
+ * @brief Reads the Elements section into the connectivity array of the mesh
+ *
+ * Large sections are parsed in chunks when OpenMP is enabled, see
+ * read_elements_in_chunks()
+ */
+void read_elements(DatScanner* dat, Mesh* M){
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int *connectivity = M->get_connectivity();
+    int *element_ids = M->get_element_ids();
+    IdMap *node_ids = M->get_node_ids();
+
+    dat->expect("Elements");
+
+    const char* section = dat->get_cursor();
+    const char* stop = dat->find_keyword("EndElements");
+    int parts = stop == NULL ? 1 : parse_chunks(section, stop);
+    if(parts > 1 && read_elements_in_chunks(dat, M, stop, parts)){
+        dat->set_cursor(stop);
+        dat->expect("EndElements");
+        return;
+    }
+    dat->set_cursor(section);
 
-     /**
-     * @brief Read conditions list
-     * 
-     * Skip section limit lines and read nodes with neumman conditions 
+    /**
+     * @name 3D MEF CHANGE
+     *
+     * Reading 4 nodes per element from input file
      */
-    for(int i = 0; i < num_neumann; i++){
-       int id;
-        dat_file >> id;
+    for(int e = 0; e < num_elements; e++){
+        element_ids[e] = dat->read_int("an element ID");
+        for(int k = 0; k < 4; k++)
+            connectivity[4 * e + k] = read_node_reference(dat, node_ids, "Elements");
+    }
 
-        M->insert_neumann_condition(new Condition(M->get_node(id-1), T_hat), i);
+    dat->expect("EndElements");
+}
+
+/**
+ * @brief Reads a Dirichlet or Neumann section, a list of node IDs
+ *
+ * @return Number of distinct nodes, sorted, see sort_condition_nodes()
+ */
+int read_condition_nodes(DatScanner* dat, Mesh* M, const char* section, const char* end_marker, int* condition_nodes, int count){
+    dat->expect(section);
+    for(int i = 0; i < count; i++)
+        condition_nodes[i] = read_node_reference(dat, M->get_node_ids(), section);
+    dat->expect(end_marker);
+    return sort_condition_nodes(condition_nodes, count);
+}
+
+/**
+ * @brief Input reader
+ *
+ * The file is memory mapped and scanned once: values go straight into the
+ * structure of arrays of the mesh, then the mesh objects are built from
+ * them. Errors are reported as file:line:column (see gid/dat_parser.hpp).
+ *
+ * When filename.meshbin holds the same mesh the text is not parsed at all,
+ * otherwise it is written after parsing, see gid/mesh_cache.hpp
+ *
+ * problem_values is the number of values before T_bar and T_hat: 2 (k and Q)
+ * for heat transfer, 0 for the second equation, see Physics::problem_values
+ */
+void read_input(string filename, Mesh* M, int problem_values = 2){
+    MappedFile dat_file;
+    dat_file.open(filename+".dat");
+
+#if MESH_CACHE
+    unsigned long long source_hash = content_hash(dat_file.get_data(), dat_file.get_size());
+    if(read_mesh_cache(filename+".meshbin", dat_file.get_size(), source_hash, M)){
+        log_message(LOG_DEBUG, "\tMesh loaded from " + filename + ".meshbin");
+        return;
     }
+#endif
+    DatScanner dat(dat_file.get_data(), dat_file.get_size(), filename+".dat");
+
+    float k = problem_values > 0 ? dat.read_float("k") : 0;
+    float Q = problem_values > 1 ? dat.read_float("Q") : 0;
+    float T_bar = dat.read_float("the Dirichlet condition value");
+    float T_hat = dat.read_float("the Neumann condition value");
+
+    int num_nodes = dat.read_int("the number of nodes", 0);
+    int num_elements = dat.read_int("the number of elements", 0);
+    int num_dirichlet = dat.read_int("the number of Dirichlet nodes", 0);
+    int num_neumann = dat.read_int("the number of Neumann nodes", 0);
+
+    M->set_problem_data(k,Q);
+    M->set_boundary_values(T_bar,T_hat);
+    M->set_quantities(num_nodes,num_elements,num_dirichlet,num_neumann);
+
+    M->init_arrays();
+
+    read_coordinates(&dat, M);
+    read_elements(&dat, M);
+    num_dirichlet = read_condition_nodes(&dat, M, "Dirichlet", "EndDirichlet", M->get_dirichlet_nodes(), num_dirichlet);
+    num_neumann = read_condition_nodes(&dat, M, "Neumann", "EndNeumann", M->get_neumann_nodes(), num_neumann);
+    M->set_quantities(num_nodes,num_elements,num_dirichlet,num_neumann);
 
-    //ALWAYS CLOSE READ FILE STREAM 
-    dat_file.close();
+    M->build_entities();
+
+#if MESH_CACHE
+    // The sparsity pattern goes into the cache too, so later runs skip building it
+    M->get_graph();
+    if(write_mesh_cache(filename+".meshbin", dat_file.get_size(), source_hash, M))
+        log_message(LOG_DEBUG, "\tMesh cache written to " + filename + ".meshbin");
+#endif
 }
 
 /**
@@ -138,29 +459,309 @@ void read_input(string filename, Mesh* M){
  * 
  */
 
+/**
+ * @brief Nodes formatted per chunk by write_output()
+ */
+#define POST_RES_CHUNK 65536
+
+/**
+ * @brief Formats one "[node_id]     [node_value]" line at out
+ *
+ * Same text as printf("%lld     %.*g\n", id, precision, value), which for
+ * precision 6 is also what ofstream << writes by default.
+ *
+ * @return Position after the line
+ */
+char* format_result_line(char* out, long long id, float value, int precision){
+    out = to_chars(out, out + 20, id).ptr;
+    memcpy(out, "     ", 5);
+    out += 5;
+    out = to_chars(out, out + 32 + precision, value, chars_format::general, precision).ptr;
+    *out++ = '\n';
+    return out;
+}
+
+/**
+ * @brief Formats a result block, header followed by one line per node and
+ * "End values"
+ *
+ * Lines are formatted with std::to_chars in chunks of POST_RES_CHUNK nodes,
+ * in parallel with OpenMP. Each chunk is formatted into its own slot of a
+ * single buffer, sized for the longest possible line, then the chunks are
+ * packed in order.
+ *
+ * @param size Output, bytes of the block
+ * @return The block, to free()
+ */
+char* format_result_block(string header, Vector* T, Mesh* M, int precision, size_t* size){
+    if(precision < 1 || precision > 17)
+        throw runtime_error("Output precision must be between 1 and 17 digits");
+
+    string footer = "End values\n";
+
+    int n = T->get_size();
+    IdMap *node_ids = M->get_node_ids();
+
+    size_t line_bound = 20 + 5 + (32 + precision) + 1;
+    int chunks = (n + POST_RES_CHUNK - 1) / POST_RES_CHUNK;
+    size_t slot = line_bound * POST_RES_CHUNK;
+
+    char* buffer = (char*) malloc(header.size() + slot * chunks + footer.size());
+    size_t* used = (size_t*) malloc(sizeof(size_t) * (chunks > 0 ? chunks : 1));
+
+    memcpy(buffer, header.data(), header.size());
+    char* slots = buffer + header.size();
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < chunks; c++){
+        char* start = slots + slot * c;
+        char* out = start;
+        int last = (c + 1) * POST_RES_CHUNK < n ? (c + 1) * POST_RES_CHUNK : n;
+        for(int i = c * POST_RES_CHUNK; i < last; i++)
+            out = format_result_line(out, node_ids->to_id(i), T->get(i), precision);
+        used[c] = out - start;
+    }
+
+    // Chunk c never moves forward, so packing in order is a memmove to the left
+    *size = header.size();
+    for(int c = 0; c < chunks; c++){
+        memmove(buffer + *size, slots + slot * c, used[c]);
+        *size += used[c];
+    }
+    memcpy(buffer + *size, footer.data(), footer.size());
+    *size += footer.size();
+
+    free(used);
+    return buffer;
+}
+
 /**
  * @brief Output Writter
  *  
+ * Values are written with the node IDs of the input file, the whole file
+ * with a single fwrite (see format_result_block()).
+ *
+ * @param precision Significant digits of the values, as in printf %.*g
  */
-void write_output(string filename, Vector* T){
+void write_output(string filename, Vector* T, Mesh* M, int precision = 6){
+    string header = "GiD Post Results File 1.0\n"
+                    "Result \"Temperature\" \"Load Case 1\" 1 Scalar OnNodes\n"
+                    "ComponentNames \"T\"\n"
+                    "Values\n";
+    size_t size;
+    char* buffer = format_result_block(header, T, M, precision, &size);
 
-    /**
-     * 
-     */
-    ofstream res_file(filename+".post.res");
-    
-    res_file << "GiD Post Results File 1.0\n";
+    string path = filename + ".post.res";
+    FILE* res_file = fopen(path.c_str(), "w");
+    if(res_file == NULL){
+        free(buffer);
+        throw runtime_error("Could not create " + path);
+    }
+    bool written = fwrite(buffer, 1, size, res_file) == size;
+    written = fclose(res_file) == 0 && written;
 
-    int n = T->get_size();
+    free(buffer);
+
+    if(!written)
+        throw runtime_error("Could not write " + path);
+}
+
+/**
+ * @brief Results of a transient analysis, one block per time step
+ *
+ * Every block is a "Temperature" result of the analysis "Transient" with
+ * the time as its step value, which GiD shows as an animation:
+ *
+    GiD Post Results File 1.0
+    Result "Temperature" "Transient" 0 Scalar OnNodes
+    ...
+    End values
+    Result "Temperature" "Transient" 0.5 Scalar OnNodes
+    ...
+ *
+ * Each step is written as soon as it is computed, so only one is in memory.
+ */
+class PostResStream {
+    private:
+        FILE* file;
+        string path;
+        int precision;
+
+    public:
+        PostResStream(string filename, int digits = 6){
+            path = filename + ".post.res";
+            precision = digits;
+            file = fopen(path.c_str(), "w");
+            if(file == NULL)
+                throw runtime_error("Could not create " + path);
+            fputs("GiD Post Results File 1.0\n", file);
+        }
+        ~PostResStream(){
+            if(file != NULL)
+                fclose(file);
+        }
+
+        void write_step(Vector* T, Mesh* M, double time){
+            char step[32];
+            snprintf(step, sizeof(step), "%.9g", time);
+            string header = "Result \"Temperature\" \"Transient\" " + string(step) + " Scalar OnNodes\n"
+                            "ComponentNames \"T\"\n"
+                            "Values\n";
+            size_t size;
+            char* buffer = format_result_block(header, T, M, precision, &size);
+            bool written = fwrite(buffer, 1, size, file) == size;
+            free(buffer);
+            if(!written)
+                throw runtime_error("Could not write " + path);
+        }
+
+        void close(){
+            bool closed = fclose(file) == 0;
+            file = NULL;
+            if(!closed)
+                throw runtime_error("Could not write " + path);
+        }
+};
+
+#define DAT_WRITE_CHUNK 8192 // lines formatted by a thread at a time
+#define DAT_WRITE_BATCH 64   // chunks formatted in parallel before each fwrite
+
+/**
+ * @brief Writes count lines, format_line(out, i) formats line i at out and
+ * returns the position after it
+ *
+ * Like write_output(), chunks of lines are formatted in parallel into slots
+ * sized for the longest line and packed in order, but a batch of chunks at
+ * a time, so meshes of tens of millions of elements do not need the whole
+ * text in memory.
+ *
+ * @return false if fwrite failed
+ */
+template <class Formatter>
+bool write_lines(FILE* file, long long count, size_t line_bound, Formatter format_line){
+    size_t slot = line_bound * DAT_WRITE_CHUNK;
+    char* buffer = (char*) malloc(slot * DAT_WRITE_BATCH);
+    size_t used[DAT_WRITE_BATCH];
+    bool written = true;
+
+    for(long long first = 0; first < count && written; first += (long long) DAT_WRITE_CHUNK * DAT_WRITE_BATCH){
+        long long remaining = count - first;
+        int chunks = (int) ((remaining + DAT_WRITE_CHUNK - 1) / DAT_WRITE_CHUNK);
+        if(chunks > DAT_WRITE_BATCH)
+            chunks = DAT_WRITE_BATCH;
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int c = 0; c < chunks; c++){
+            char* start = buffer + slot * c;
+            char* out = start;
+            long long begin = first + (long long) c * DAT_WRITE_CHUNK;
+            long long end = begin + DAT_WRITE_CHUNK < count ? begin + DAT_WRITE_CHUNK : count;
+            for(long long i = begin; i < end; i++)
+                out = format_line(out, i);
+            used[c] = out - start;
+        }
+
+        size_t size = 0;
+        for(int c = 0; c < chunks; c++){
+            memmove(buffer + size, buffer + slot * c, used[c]);
+            size += used[c];
+        }
+        written = fwrite(buffer, 1, size, file) == size;
+    }
+
+    free(buffer);
+    return written;
+}
+
+/**
+ * @brief Writes M as filename.dat, in the format of read_input()
+ *
+ * Coordinates are written with the shortest text that reads back to the
+ * same float, so parsing the file gives exactly the same mesh. The file is
+ * binary (no \r\n on Windows) so its size and hash are the ones the mesh
+ * cache checks.
+ */
+void write_dat(string filename, Mesh* M){
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int num_dirichlet = M->get_quantity(NUM_DIRICHLET);
+    int num_neumann = M->get_quantity(NUM_NEUMANN);
 
-    res_file << "Result \"Temperature\" \"Load Case 1\" " << 1 << " Scalar OnNodes\n";
-    res_file << "ComponentNames \"T\"\n";
-    res_file << "Values\n";
+    IdMap* node_ids = M->get_node_ids();
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+    int *connectivity = M->get_connectivity(), *element_ids = M->get_element_ids();
+    int *dirichlet_nodes = M->get_dirichlet_nodes(), *neumann_nodes = M->get_neumann_nodes();
 
-    for(int i = 0; i < n; i++)
-        res_file << i+1 << "     " << T->get(i) << "\n";
+    string path = filename + ".dat";
+    FILE* file = fopen(path.c_str(), "wb");
+    if(file == NULL)
+        throw runtime_error("Could not create " + path);
+
+    char header[256];
+    char* out = header;
+    float data[4] = {M->get_problem_data(THERMAL_CONDUCTIVITY), M->get_problem_data(HEAT_SOURCE),
+                     M->get_problem_data(DIRICHLET_VALUE), M->get_problem_data(NEUMANN_VALUE)};
+    for(int p = 0; p < 4; p++){
+        out = to_chars(out, out + 32, data[p]).ptr;
+        *out++ = p % 2 == 0 ? ' ' : '\n';
+    }
+    int quantities[4] = {num_nodes, num_elements, num_dirichlet, num_neumann};
+    for(int q = 0; q < 4; q++){
+        out = to_chars(out, out + 12, quantities[q]).ptr;
+        *out++ = q < 3 ? ' ' : '\n';
+    }
+    bool written = fwrite(header, 1, out - header, file) == (size_t) (out - header);
 
-    res_file << "End values\n";
+    written = written && fputs("\nCoordinates\n", file) >= 0;
+    written = written && write_lines(file, num_nodes, 20 + 3 * 33 + 1, [&](char* line, long long i){
+        line = to_chars(line, line + 20, node_ids->to_id(i)).ptr;
+        float coordinates[3] = {x[i], y[i], z[i]};
+        for(int d = 0; d < 3; d++){
+            *line++ = ' ';
+            line = to_chars(line, line + 32, coordinates[d]).ptr;
+        }
+        *line++ = '\n';
+        return line;
+    });
+    written = written && fputs("EndCoordinates\n\nElements\n", file) >= 0;
+    written = written && write_lines(file, num_elements, 12 + 4 * 21 + 1, [&](char* line, long long e){
+        line = to_chars(line, line + 12, element_ids[e]).ptr;
+        for(int v = 0; v < 4; v++){
+            *line++ = ' ';
+            line = to_chars(line, line + 20, node_ids->to_id(connectivity[4 * e + v])).ptr;
+        }
+        *line++ = '\n';
+        return line;
+    });
+    written = written && fputs("EndElements\n\nDirichlet\n", file) >= 0;
+    written = written && write_lines(file, num_dirichlet, 21, [&](char* line, long long c){
+        line = to_chars(line, line + 20, node_ids->to_id(dirichlet_nodes[c])).ptr;
+        *line++ = '\n';
+        return line;
+    });
+    written = written && fputs("EndDirichlet\n\nNeumann\n", file) >= 0;
+    written = written && write_lines(file, num_neumann, 21, [&](char* line, long long c){
+        line = to_chars(line, line + 20, node_ids->to_id(neumann_nodes[c])).ptr;
+        *line++ = '\n';
+        return line;
+    });
+    written = written && fputs("EndNeumann\n", file) >= 0;
+    written = fclose(file) == 0 && written;
+
+    if(!written)
+        throw runtime_error("Could not write " + path);
+}
+
+/**
+ * @brief Writes the mesh cache of filename.dat, so the first read_input()
+ * maps it instead of parsing, see gid/mesh_cache.hpp
+ */
+void write_dat_cache(string filename, Mesh* M){
+    MappedFile dat_file;
+    dat_file.open(filename+".dat");
+    unsigned long long source_hash = content_hash(dat_file.get_data(), dat_file.get_size());
 
-    res_file.close();
+    M->get_graph();
+    if(!write_mesh_cache(filename+".meshbin", dat_file.get_size(), source_hash, M))
+        throw runtime_error("Could not write " + filename + ".meshbin");
 }
@@ -0,0 +1,133 @@
+/**
+ * @file gid/mapped_file.hpp
+ *
+ * @brief View of a whole file in memory
+ *
+ * On POSIX systems the file is memory mapped, so the readers scan the page
+ * cache directly without copying it into a stream buffer. A writable view
+ * is private: changes are never written back to the file. On Windows
+ * (MinGW builds) the file is read at once into a malloc buffer, which gives
+ * the readers the same contiguous view.
+ */
+#include <stdexcept>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool file_exists(string path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+    fclose(file);
+    return true;
+}
+
+class MappedFile
+{
+private:
+    const char *data;
+    size_t size;
+    bool mapped; // data comes from mmap(), otherwise from malloc()
+
+public:
+    MappedFile()
+    {
+        data = NULL;
+        size = 0;
+        mapped = false;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief Maps the whole file, throws if it can not be opened
+     *
+     * @param writable Allow changes to the data, on a private copy of the touched pages
+     */
+    void open(string path, bool writable = false)
+    {
+        close();
+
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw runtime_error("Could not open " + path);
+
+        struct stat info;
+        if (fstat(fd, &info) == -1)
+        {
+            ::close(fd);
+            throw runtime_error("Could not read the size of " + path);
+        }
+        size = (size_t)info.st_size;
+
+        if (size > 0)
+        {
+            void *view = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED)
+            {
+                ::close(fd);
+                throw runtime_error("Could not map " + path);
+            }
+            madvise(view, size, MADV_SEQUENTIAL);
+            data = (const char *)view;
+            mapped = true;
+        }
+        ::close(fd);
+#else
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == NULL)
+            throw runtime_error("Could not open " + path);
+
+        fseek(file, 0, SEEK_END);
+        size = (size_t)ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        char *buffer = (char *)malloc(size > 0 ? size : 1);
+        if (fread(buffer, 1, size, file) != size)
+        {
+            fclose(file);
+            free(buffer);
+            throw runtime_error("Could not read " + path);
+        }
+        fclose(file);
+        data = buffer;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap((void *)data, size);
+        else
+            free((void *)data);
+#else
+        free((void *)data);
+#endif
+        data = NULL;
+        size = 0;
+        mapped = false;
+    }
+
+    const char *get_data()
+    {
+        return data;
+    }
+
+    size_t get_size()
+    {
+        return size;
+    }
+};
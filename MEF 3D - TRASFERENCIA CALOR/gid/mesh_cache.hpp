@@ -0,0 +1,331 @@
+/**
+ * @file gid/mesh_cache.hpp
+ *
+ * @brief Binary mesh cache (.meshbin)
+ *
+ * read_input() writes FILENAME.meshbin after parsing FILENAME.dat, and the
+ * next runs map it instead of parsing the text again. The arrays are stored
+ * exactly as Mesh keeps them, so loading is mapping the file and pointing
+ * the structure of arrays of the mesh into it (Mesh::use_arrays()).
+ *
+ * Layout, native byte order:
+ *
+ *  - MeshCacheHeader
+ *  - Sections, each starting at a multiple of MESH_CACHE_ALIGNMENT bytes:
+ *    x, y, z (float), connectivity, element IDs, dirichlet nodes, neumann
+ *    nodes (int), file node IDs (long long, only if they are not 1 ... n)
+ *    and the CSR arrays of MeshGraph (int, optional)
+ *
+ * The cache is valid only for the .dat it was built from: the header keeps
+ * the size and a content hash of the text, both are checked before using it.
+ * The section sizes must match the counts of the header and every index
+ * must be inside the mesh, see cache_is_consistent(). Any mismatch or
+ * damaged cache just falls back to parsing.
+ */
+#include <cstdio>
+#include <cstring>
+
+#define MESH_CACHE_MAGIC "MESHBIN"
+#define MESH_CACHE_VERSION 3 // 2: caches of version 1 may hold shuffled nodes in file order, 3: unsorted condition lists
+#define MESH_CACHE_ENDIAN 0x01020304
+#define MESH_CACHE_ALIGNMENT 64
+
+/**
+ * @brief Set MESH_CACHE to 0 to always parse the text
+ */
+#ifndef MESH_CACHE
+#define MESH_CACHE 1
+#endif
+
+enum cache_section
+{
+    CACHE_X,
+    CACHE_Y,
+    CACHE_Z,
+    CACHE_CONNECTIVITY,
+    CACHE_ELEMENT_IDS,
+    CACHE_DIRICHLET,
+    CACHE_NEUMANN,
+    CACHE_NODE_IDS,       // empty when the node IDs are 1 ... n
+    CACHE_ELEMENT_OFFSET, // MeshGraph sections, empty when there is no graph
+    CACHE_ELEMENT_INDEX,
+    CACHE_NODE_OFFSET,
+    CACHE_NODE_INDEX,
+    CACHE_SECTIONS
+};
+
+struct MeshCacheHeader
+{
+    char magic[8];
+    int version;
+    int endian; // MESH_CACHE_ENDIAN as written by the machine that built the cache
+    unsigned long long source_size;
+    unsigned long long source_hash;
+    float problem_data[4]; // k, Q, T_bar, T_hat
+    int quantities[4];     // nodes, elements, dirichlet, neumann
+    int has_graph;
+    int reserved;
+    unsigned long long section_offset[CACHE_SECTIONS];
+    unsigned long long section_size[CACHE_SECTIONS]; // bytes
+};
+
+/**
+ * @brief 64 bit content hash of a buffer
+ *
+ * Four independent multiply / rotate lanes over 8 byte words, so it runs at
+ * close to memory speed, then the tail and the length are mixed in.
+ */
+unsigned long long content_hash(const char* data, size_t size){
+    const unsigned long long prime = 0x9E3779B97F4A7C15ULL;
+    unsigned long long lane[4] = {prime, prime ^ 1, prime ^ 2, prime ^ 3};
+
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32)
+        for(int l = 0; l < 4; l++){
+            unsigned long long word;
+            memcpy(&word, data + i + 8 * l, 8);
+            lane[l] = (lane[l] ^ word) * prime;
+            lane[l] = (lane[l] << 29) | (lane[l] >> 35);
+        }
+
+    unsigned long long hash = size;
+    for(int l = 0; l < 4; l++)
+        hash = (hash ^ lane[l]) * prime;
+    for(; i < size; i++)
+        hash = (hash ^ (unsigned char) data[i]) * 0x100000001B3ULL;
+
+    hash ^= hash >> 31;
+    hash *= prime;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+/**
+ * @brief Writes the cache of M, built from a source of the given size and hash
+ *
+ * The file is written under a temporary name and renamed, so an interrupted
+ * run never leaves a half written cache behind.
+ *
+ * @return false if the file could not be written, which is not an error
+ */
+bool write_mesh_cache(string path, unsigned long long source_size, unsigned long long source_hash, Mesh* M){
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = MESH_CACHE_VERSION;
+    header.endian = MESH_CACHE_ENDIAN;
+    header.source_size = source_size;
+    header.source_hash = source_hash;
+    header.problem_data[THERMAL_CONDUCTIVITY] = M->get_problem_data(THERMAL_CONDUCTIVITY);
+    header.problem_data[HEAT_SOURCE] = M->get_problem_data(HEAT_SOURCE);
+    header.problem_data[DIRICHLET_VALUE] = M->get_problem_data(DIRICHLET_VALUE);
+    header.problem_data[NEUMANN_VALUE] = M->get_problem_data(NEUMANN_VALUE);
+
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    header.quantities[NUM_NODES] = num_nodes;
+    header.quantities[NUM_ELEMENTS] = num_elements;
+    header.quantities[NUM_DIRICHLET] = M->get_quantity(NUM_DIRICHLET);
+    header.quantities[NUM_NEUMANN] = M->get_quantity(NUM_NEUMANN);
+
+    IdMap* node_ids = M->get_node_ids();
+    long long* file_ids = NULL;
+    if(!node_ids->is_identity()){
+        file_ids = (long long*) malloc(sizeof(long long) * num_nodes);
+        for(int i = 0; i < num_nodes; i++)
+            file_ids[i] = node_ids->to_id(i);
+    }
+
+    MeshGraph* G = M->has_graph() ? M->get_graph() : NULL;
+    header.has_graph = G != NULL;
+
+    const void* data[CACHE_SECTIONS] = {
+        M->get_x_coordinates(), M->get_y_coordinates(), M->get_z_coordinates(),
+        M->get_connectivity(), M->get_element_ids(), M->get_dirichlet_nodes(), M->get_neumann_nodes(),
+        file_ids,
+        G ? G->get_element_offsets() : NULL, G ? G->get_element_indices() : NULL,
+        G ? G->get_node_offsets() : NULL, G ? G->get_node_indices() : NULL};
+
+    header.section_size[CACHE_X] = sizeof(float) * num_nodes;
+    header.section_size[CACHE_Y] = sizeof(float) * num_nodes;
+    header.section_size[CACHE_Z] = sizeof(float) * num_nodes;
+    header.section_size[CACHE_CONNECTIVITY] = sizeof(int) * 4 * (size_t) num_elements;
+    header.section_size[CACHE_ELEMENT_IDS] = sizeof(int) * num_elements;
+    header.section_size[CACHE_DIRICHLET] = sizeof(int) * header.quantities[NUM_DIRICHLET];
+    header.section_size[CACHE_NEUMANN] = sizeof(int) * header.quantities[NUM_NEUMANN];
+    header.section_size[CACHE_NODE_IDS] = file_ids ? sizeof(long long) * num_nodes : 0;
+    if(G != NULL){
+        header.section_size[CACHE_ELEMENT_OFFSET] = sizeof(int) * (num_nodes + 1);
+        header.section_size[CACHE_ELEMENT_INDEX] = sizeof(int) * 4 * (size_t) num_elements;
+        header.section_size[CACHE_NODE_OFFSET] = sizeof(int) * (num_nodes + 1);
+        header.section_size[CACHE_NODE_INDEX] = sizeof(int) * (size_t) G->get_node_offsets()[num_nodes];
+    }
+
+    unsigned long long offset = sizeof(MeshCacheHeader);
+    for(int s = 0; s < CACHE_SECTIONS; s++){
+        offset = (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+        header.section_offset[s] = offset;
+        offset += header.section_size[s];
+    }
+
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    bool written = file != NULL;
+    if(written){
+        static const char padding[MESH_CACHE_ALIGNMENT] = {0};
+        unsigned long long position = sizeof(header);
+        written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        for(int s = 0; s < CACHE_SECTIONS && written; s++){
+            written = fwrite(padding, 1, header.section_offset[s] - position, file) == header.section_offset[s] - position;
+            if(header.section_size[s] > 0)
+                written = written && fwrite(data[s], 1, header.section_size[s], file) == header.section_size[s];
+            position = header.section_offset[s] + header.section_size[s];
+        }
+        written = fclose(file) == 0 && written;
+    }
+
+    if(written){
+        remove(path.c_str());
+        written = rename(temporary.c_str(), path.c_str()) == 0;
+    }
+    if(!written)
+        remove(temporary.c_str());
+
+    free(file_ids);
+    return written;
+}
+
+/**
+ * @brief True if every value of an int section is in [0, limit)
+ */
+bool indices_below(const char* section, unsigned long long bytes, long long limit){
+    const int* values = (const int*) section;
+    long long count = (long long) (bytes / sizeof(int));
+    for(long long i = 0; i < count; i++)
+        if(values[i] < 0 || values[i] >= limit)
+            return false;
+    return true;
+}
+
+/**
+ * @brief True if the CSR offsets of a section start at 0, never decrease
+ * and end at total
+ */
+bool offsets_valid(const char* section, int rows, long long total){
+    const int* offset = (const int*) section;
+    if(offset[0] != 0 || offset[rows] != total)
+        return false;
+    for(int i = 0; i < rows; i++)
+        if(offset[i + 1] < offset[i])
+            return false;
+    return true;
+}
+
+/**
+ * @brief Checks a mapped cache against its own header before Mesh uses it
+ *
+ * Section sizes must be the ones the counts give, and connectivity,
+ * conditions and graphs must only reference existing nodes and elements,
+ * so a damaged file can not make the solver read outside the arrays.
+ */
+bool cache_is_consistent(MeshCacheHeader* header, const char* base){
+    long long n = header->quantities[NUM_NODES], e = header->quantities[NUM_ELEMENTS];
+    long long d = header->quantities[NUM_DIRICHLET], m = header->quantities[NUM_NEUMANN];
+    if(n < 0 || e < 0 || d < 0 || m < 0)
+        return false;
+
+    unsigned long long expected[CACHE_SECTIONS] = {
+        4ULL * n, 4ULL * n, 4ULL * n, 16ULL * e, 4ULL * e, 4ULL * d, 4ULL * m,
+        header->section_size[CACHE_NODE_IDS] == 0 ? 0 : 8ULL * n,
+        header->has_graph ? 4ULL * (n + 1) : 0, header->has_graph ? 16ULL * e : 0,
+        header->has_graph ? 4ULL * (n + 1) : 0, header->section_size[CACHE_NODE_INDEX]};
+    for(int s = 0; s < CACHE_SECTIONS; s++)
+        if(header->section_size[s] != expected[s])
+            return false;
+
+    const char* section[CACHE_SECTIONS];
+    for(int s = 0; s < CACHE_SECTIONS; s++)
+        section[s] = base + header->section_offset[s];
+
+    if(!indices_below(section[CACHE_CONNECTIVITY], expected[CACHE_CONNECTIVITY], n) ||
+       !indices_below(section[CACHE_DIRICHLET], expected[CACHE_DIRICHLET], n) ||
+       !indices_below(section[CACHE_NEUMANN], expected[CACHE_NEUMANN], n))
+        return false;
+
+    if(!header->has_graph)
+        return header->section_size[CACHE_NODE_INDEX] == 0;
+    return offsets_valid(section[CACHE_ELEMENT_OFFSET], (int) n, 4 * e) &&
+           indices_below(section[CACHE_ELEMENT_INDEX], expected[CACHE_ELEMENT_INDEX], e) &&
+           offsets_valid(section[CACHE_NODE_OFFSET], (int) n, (long long) (header->section_size[CACHE_NODE_INDEX] / sizeof(int))) &&
+           indices_below(section[CACHE_NODE_INDEX], header->section_size[CACHE_NODE_INDEX], n);
+}
+
+/**
+ * @brief Loads M from a cache if it exists and matches the source
+ *
+ * @return false if there is no valid cache, M is left untouched
+ */
+bool read_mesh_cache(string path, unsigned long long source_size, unsigned long long source_hash, Mesh* M){
+    if(!file_exists(path))
+        return false;
+
+    MappedFile* storage = M->get_storage();
+    try{
+        storage->open(path, true);
+    }
+    catch(const exception&){
+        return false;
+    }
+
+    const char* base = storage->get_data();
+    size_t size = storage->get_size();
+    MeshCacheHeader header;
+
+    bool valid = size >= sizeof(header);
+    if(valid){
+        memcpy(&header, base, sizeof(header));
+        valid = memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) == 0 &&
+                header.version == MESH_CACHE_VERSION && header.endian == MESH_CACHE_ENDIAN &&
+                header.source_size == source_size && header.source_hash == source_hash;
+    }
+    for(int s = 0; s < CACHE_SECTIONS && valid; s++)
+        valid = header.section_offset[s] % MESH_CACHE_ALIGNMENT == 0 &&
+                header.section_offset[s] <= size && header.section_size[s] <= size - header.section_offset[s];
+    valid = valid && cache_is_consistent(&header, base);
+    if(!valid){
+        storage->close();
+        return false;
+    }
+
+    M->set_problem_data(header.problem_data[THERMAL_CONDUCTIVITY], header.problem_data[HEAT_SOURCE]);
+    M->set_boundary_values(header.problem_data[DIRICHLET_VALUE], header.problem_data[NEUMANN_VALUE]);
+    M->set_quantities(header.quantities[NUM_NODES], header.quantities[NUM_ELEMENTS],
+                      header.quantities[NUM_DIRICHLET], header.quantities[NUM_NEUMANN]);
+    M->init_entity_arrays();
+
+    char* section[CACHE_SECTIONS];
+    for(int s = 0; s < CACHE_SECTIONS; s++)
+        section[s] = (char*) base + header.section_offset[s];
+
+    M->use_arrays((float*) section[CACHE_X], (float*) section[CACHE_Y], (float*) section[CACHE_Z],
+                  (int*) section[CACHE_CONNECTIVITY], (int*) section[CACHE_ELEMENT_IDS],
+                  (int*) section[CACHE_DIRICHLET], (int*) section[CACHE_NEUMANN]);
+
+    int num_nodes = header.quantities[NUM_NODES];
+    if(header.section_size[CACHE_NODE_IDS] == 0)
+        M->get_node_ids()->build_identity(num_nodes);
+    else
+        M->get_node_ids()->build((long long*) section[CACHE_NODE_IDS], num_nodes);
+
+    if(header.has_graph){
+        MeshGraph* G = new MeshGraph();
+        G->adopt(num_nodes, header.quantities[NUM_ELEMENTS],
+                 (int*) section[CACHE_ELEMENT_OFFSET], (int*) section[CACHE_ELEMENT_INDEX],
+                 (int*) section[CACHE_NODE_OFFSET], (int*) section[CACHE_NODE_INDEX]);
+        M->set_graph(G);
+    }
+
+    M->build_entities();
+    return true;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file gid/post_binary.hpp
+ *
+ * @brief GiD binary post results (.post.bin)
+ *
+ * Same result as write_output(), "Temperature" of "Load Case 1" on the
+ * nodes, in the binary layout of the gidpost library that GiD opens directly:
+ *
+ *  - int32 1, to detect the byte order
+ *  - Every line of the ASCII format (header, Result, ComponentNames, Values,
+ *    End Values) as a string: int32 length including the final '\0',
+ *    followed by the characters and the '\0'
+ *  - Each value as int32 node ID followed by float32 value
+ *
+ * gidpost writes the stream through zlib. Compiling with -DWITH_ZLIB
+ * (and linking -lz) does the same; without it the stream is written
+ * uncompressed, which GiD still reads because zlib reads plain data
+ * transparently. WITH_ZLIB is the same option --vtu-zlib needs:
+ *
+ *  g++ -O2 -fopenmp -DWITH_ZLIB main.cpp -o heat3d.exe -lz
+ */
+#include <cstdio>
+#include <climits>
+#include <cstring>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#define POST_BINARY_HEADER "GiD Post Results File 1.1"
+
+/**
+ * @brief Growing memory buffer, the whole file is written at once
+ */
+class PostBinaryBuffer
+{
+private:
+    char *data;
+    size_t size;
+    size_t capacity;
+
+public:
+    PostBinaryBuffer(size_t initial_capacity)
+    {
+        capacity = initial_capacity > 0 ? initial_capacity : 1;
+        data = (char *)malloc(capacity);
+        size = 0;
+    }
+
+    ~PostBinaryBuffer()
+    {
+        free(data);
+    }
+
+    void append(const void *bytes, size_t count)
+    {
+        if (size + count > capacity)
+        {
+            while (size + count > capacity)
+                capacity *= 2;
+            data = (char *)realloc(data, capacity);
+        }
+        memcpy(data + size, bytes, count);
+        size += count;
+    }
+
+    void append_int(int value)
+    {
+        append(&value, sizeof(int));
+    }
+
+    void append_float(float value)
+    {
+        append(&value, sizeof(float));
+    }
+
+    void append_string(const char *text)
+    {
+        int length = strlen(text) + 1;
+        append_int(length);
+        append(text, length);
+    }
+
+    const char *get_data()
+    {
+        return data;
+    }
+
+    size_t get_size()
+    {
+        return size;
+    }
+};
+
+/**
+ * @brief Binary output writer, writes filename.post.bin
+ */
+void write_output_binary(string filename, Vector* T, Mesh* M){
+    int n = T->get_size();
+    IdMap *node_ids = M->get_node_ids();
+
+    PostBinaryBuffer buffer(256 + (size_t) n * (sizeof(int) + sizeof(float)));
+
+    buffer.append_int(1);
+    buffer.append_string(POST_BINARY_HEADER);
+    buffer.append_string("Result \"Temperature\" \"Load Case 1\" 1 Scalar OnNodes");
+    buffer.append_string("ComponentNames \"T\"");
+    buffer.append_string("Values");
+
+    for(int i = 0; i < n; i++){
+        long long id = node_ids->to_id(i);
+        if(id < INT_MIN || id > INT_MAX)
+            throw runtime_error("Node ID " + to_string(id) + " does not fit the 32 bit IDs of the binary post format");
+        buffer.append_int((int) id);
+        buffer.append_float(T->get(i));
+    }
+
+    buffer.append_string("End Values");
+
+    string path = filename + ".post.bin";
+    bool written;
+#ifdef WITH_ZLIB
+    gzFile file = gzopen(path.c_str(), "wb1");
+    if(file == NULL)
+        throw runtime_error("Could not create " + path);
+    written = gzwrite(file, buffer.get_data(), (unsigned) buffer.get_size()) == (int) buffer.get_size();
+    written = gzclose(file) == Z_OK && written;
+#else
+    FILE* file = fopen(path.c_str(), "wb");
+    if(file == NULL)
+        throw runtime_error("Could not create " + path);
+    written = fwrite(buffer.get_data(), 1, buffer.get_size(), file) == buffer.get_size();
+    written = fclose(file) == 0 && written;
+#endif
+
+    if(!written)
+        throw runtime_error("Could not write " + path);
+}
@@ -0,0 +1,266 @@
+/**
+ * @file gid/post_res_compare.hpp
+ *
+ * @brief Comparison of nodal results with a reference .post.res
+ *
+ * The files are read one line at a time through a fixed stdio buffer, so
+ * memory does not grow with the number of nodes and files larger than RAM
+ * can be compared. Values are matched by position: both sides must list
+ * the same node IDs in the same order, as write_output() and GiD do, and
+ * the comparison throws at the first ID that differs.
+ *
+ * Reported, with the reference as the exact values:
+ *
+ *  - largest absolute error and its node ID
+ *  - largest relative error |value - reference| / |reference| and its node
+ *    ID, nodes with a zero reference only count in the absolute error
+ *  - L2 norm of the error and relative L2 = ||value - reference|| / ||reference||
+ *  - the POST_RES_WORST nodes with the largest absolute error
+ *  - values that are NaN or infinite, which make every error infinite
+ *
+ * results_within() accepts a comparison by its relative L2 error. The
+ * largest relative error is only reported: single nodes next to a change of
+ * boundary condition are far less accurate than the field, and the results
+ * of the MALLA_* projects are off there by about 2e-3.
+ */
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#define POST_RES_WORST 10              // worst nodes kept by the comparison
+#define POST_RES_READ_BUFFER (1 << 20) // stdio buffer of each file
+#define POST_RES_MAX_LINE 256
+
+/**
+ * @brief Largest relative L2 error accepted by results_within()
+ */
+#ifndef POST_RES_TOLERANCE
+#define POST_RES_TOLERANCE 1e-3
+#endif
+
+struct NodeError
+{
+    long long id;
+    double value;
+    double reference;
+    double error; // absolute
+};
+
+struct ResultComparison
+{
+    long long nodes;
+    long long non_finite; // NaN or infinite values
+    double max_abs_error;
+    long long max_abs_id;
+    double max_rel_error;
+    long long max_rel_id;
+    double l2_error;
+    double rel_l2_error;
+
+    NodeError worst[POST_RES_WORST]; // largest absolute error first
+    int num_worst;
+};
+
+/**
+ * @brief Reads the values of the first result of a .post.res, one at a time
+ */
+class PostResReader
+{
+private:
+    FILE *file;
+    string path;
+    char line[POST_RES_MAX_LINE];
+    long long line_number;
+
+    bool read_line()
+    {
+        if (fgets(line, POST_RES_MAX_LINE, file) == NULL)
+            return false;
+        line_number++;
+        return true;
+    }
+
+public:
+    PostResReader(string file_path)
+    {
+        path = file_path;
+        line_number = 0;
+        file = fopen(path.c_str(), "r");
+        if (file == NULL)
+            throw runtime_error("Could not open " + path);
+        setvbuf(file, NULL, _IOFBF, POST_RES_READ_BUFFER);
+
+        while (read_line())
+            if (strncmp(line, "Values", 6) == 0)
+                return;
+        fclose(file);
+        throw runtime_error(path + " has no Values section");
+    }
+
+    ~PostResReader()
+    {
+        fclose(file);
+    }
+
+    /**
+     * @brief Next node ID and value, false at End values
+     */
+    bool next(long long *id, double *value)
+    {
+        if (!read_line())
+            throw runtime_error(path + " ends before End values");
+        if (strncmp(line, "End", 3) == 0) // "End values" or "End Values"
+            return false;
+
+        char *end;
+        *id = strtoll(line, &end, 10);
+        char *value_start = end;
+        *value = strtod(value_start, &end);
+        if (end == line || end == value_start)
+            throw runtime_error(path + ": line " + to_string(line_number) + " is not a node ID and a value");
+        return true;
+    }
+};
+
+/**
+ * @brief Accumulates the errors of node after node
+ */
+class ResultComparer
+{
+private:
+    ResultComparison result;
+    double squared_error, squared_reference;
+
+public:
+    ResultComparer()
+    {
+        memset(&result, 0, sizeof(result));
+        squared_error = squared_reference = 0;
+    }
+
+    void add(long long id, double value, double reference)
+    {
+        result.nodes++;
+        double error = fabs(value - reference);
+        if (!isfinite(value) || !isfinite(reference))
+        {
+            result.non_finite++;
+            error = INFINITY;
+        }
+
+        if (result.nodes == 1)
+            result.max_abs_id = result.max_rel_id = id;
+        if (error > result.max_abs_error)
+        {
+            result.max_abs_error = error;
+            result.max_abs_id = id;
+        }
+        if (reference != 0 && error / fabs(reference) > result.max_rel_error)
+        {
+            result.max_rel_error = error / fabs(reference);
+            result.max_rel_id = id;
+        }
+        squared_error += error * error;
+        squared_reference += reference * reference;
+
+        // Insertion into the short list of worst nodes
+        if (result.num_worst < POST_RES_WORST || error > result.worst[result.num_worst - 1].error)
+        {
+            int position = result.num_worst < POST_RES_WORST ? result.num_worst++ : POST_RES_WORST - 1;
+            while (position > 0 && result.worst[position - 1].error < error)
+            {
+                result.worst[position] = result.worst[position - 1];
+                position--;
+            }
+            result.worst[position] = {id, value, reference, error};
+        }
+    }
+
+    ResultComparison finish()
+    {
+        result.l2_error = sqrt(squared_error);
+        result.rel_l2_error = squared_reference > 0 ? result.l2_error / sqrt(squared_reference) : result.l2_error;
+        return result;
+    }
+};
+
+/**
+ * @brief Compares a results file with a reference results file
+ */
+ResultComparison compare_post_res(string path, string reference_path)
+{
+    PostResReader values(path), references(reference_path);
+    ResultComparer comparer;
+
+    long long id, reference_id;
+    double value, reference;
+    while (true)
+    {
+        bool more = values.next(&id, &value);
+        bool more_references = references.next(&reference_id, &reference);
+        if (more != more_references)
+            throw runtime_error(path + " and " + reference_path + " have a different number of nodes");
+        if (!more)
+            break;
+        if (id != reference_id)
+            throw runtime_error(path + " has node " + to_string(id) + " where " + reference_path + " has node " + to_string(reference_id));
+        comparer.add(id, value, reference);
+    }
+    return comparer.finish();
+}
+
+/**
+ * @brief Compares the nodal values of a solution in memory with a reference
+ * results file, nodes by compact index with the IDs of M
+ */
+ResultComparison compare_post_res(Vector *T, Mesh *M, string reference_path)
+{
+    PostResReader references(reference_path);
+    ResultComparer comparer;
+    IdMap *node_ids = M->get_node_ids();
+
+    long long reference_id;
+    double reference;
+    int i = 0;
+    while (references.next(&reference_id, &reference))
+    {
+        if (i == T->get_size())
+            throw runtime_error(reference_path + " has more nodes than the solution");
+        if (node_ids->to_id(i) != reference_id)
+            throw runtime_error(reference_path + " has node " + to_string(reference_id) + " where the solution has node " + to_string(node_ids->to_id(i)));
+        comparer.add(reference_id, T->get(i), reference);
+        i++;
+    }
+    if (i != T->get_size())
+        throw runtime_error(reference_path + " has fewer nodes than the solution");
+    return comparer.finish();
+}
+
+/**
+ * @brief Prints a comparison
+ */
+void report_comparison(ResultComparison *comparison)
+{
+    if (!log_enabled(LOG_SUMMARY))
+        return;
+
+    cout << "Compared nodes: " << comparison->nodes << "\n";
+    if (comparison->non_finite > 0)
+        cout << "Non finite values: " << comparison->non_finite << "\n";
+    cout << "Max absolute error: " << comparison->max_abs_error << " (node " << comparison->max_abs_id << ")\n";
+    cout << "Max relative error: " << comparison->max_rel_error << " (node " << comparison->max_rel_id << ")\n";
+    cout << "L2 error: " << comparison->l2_error << ", relative L2 error: " << comparison->rel_l2_error << "\n";
+    cout << "Worst nodes\n**********************\n";
+    for (int w = 0; w < comparison->num_worst; w++)
+        cout << "Node " << comparison->worst[w].id << ": " << comparison->worst[w].value << ", reference "
+             << comparison->worst[w].reference << ", error " << comparison->worst[w].error << "\n";
+}
+
+/**
+ * @brief True if the comparison is within tolerance: no value is NaN or
+ * infinite and the relative L2 error is at most tolerance
+ */
+bool results_within(ResultComparison *comparison, double tolerance = POST_RES_TOLERANCE)
+{
+    return comparison->non_finite == 0 && comparison->rel_l2_error <= tolerance;
+}
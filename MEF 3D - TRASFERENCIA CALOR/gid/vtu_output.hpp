@@ -0,0 +1,240 @@
+/**
+ * @file gid/vtu_output.hpp
+ *
+ * @brief VTK XML unstructured grid (.vtu) output, for ParaView
+ *
+ * One file holds the mesh and any number of result fields, so it does not
+ * need the GiD project next to it. Every array goes to a single
+ * <AppendedData> block at the end of the file:
+ *
+ *  - VTU_RAW: bytes as they are in memory, the fastest to write and read
+ *  - VTU_BASE64: the same bytes in base64, for tools that need the file to
+ *    be valid text
+ *
+ * Each array is a UInt64 byte count followed by the data. Compressed arrays
+ * (vtkZLibDataCompressor, needs -DWITH_ZLIB and -lz) use instead the
+ * header [number of blocks, block size, size of the last block, compressed
+ * size of every block] followed by the compressed blocks. In base64 the
+ * header and the data are encoded separately, as VTK reads them.
+ *
+ * Arrays are little endian, the byte order of every target of this project.
+ */
+#include <cstdio>
+#include <cstring>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#define VTU_TETRA 10                // VTK cell type of a 4 node tetrahedron
+#define VTU_COMPRESSION_BLOCK 1048576 // uncompressed bytes per zlib block
+
+enum vtu_encoding
+{
+    VTU_RAW,
+    VTU_BASE64
+};
+
+/**
+ * @brief A result field, on the nodes or on the elements
+ */
+struct VtuField
+{
+    string name;
+    int components;  // 1 = scalar, 3 = vector
+    bool on_nodes;   // false = one value per element
+    float *values;   // components values per node or element
+};
+
+/**
+ * @brief Appended data block of a .vtu file, built in memory
+ */
+class VtuAppendedData
+{
+private:
+    string data;
+    vtu_encoding encoding;
+    bool compress;
+
+    void append_base64(const unsigned char *bytes, size_t size)
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        size_t start = data.size();
+        data.resize(start + (size + 2) / 3 * 4);
+        char *out = &data[start];
+
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3)
+        {
+            unsigned int group = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+            *out++ = alphabet[(group >> 18) & 63];
+            *out++ = alphabet[(group >> 12) & 63];
+            *out++ = alphabet[(group >> 6) & 63];
+            *out++ = alphabet[group & 63];
+        }
+        if (i < size)
+        {
+            unsigned int group = bytes[i] << 16;
+            if (i + 1 < size)
+                group |= bytes[i + 1] << 8;
+            *out++ = alphabet[(group >> 18) & 63];
+            *out++ = alphabet[(group >> 12) & 63];
+            *out++ = i + 1 < size ? alphabet[(group >> 6) & 63] : '=';
+            *out++ = '=';
+        }
+    }
+
+    void append_bytes(const void *bytes, size_t size)
+    {
+        if (encoding == VTU_BASE64)
+            append_base64((const unsigned char *)bytes, size);
+        else
+            data.append((const char *)bytes, size);
+    }
+
+public:
+    VtuAppendedData(vtu_encoding data_encoding, bool compressed)
+    {
+        encoding = data_encoding;
+        compress = compressed;
+    }
+
+    /**
+     * @brief Adds an array
+     *
+     * @return Its offset, for the format="appended" attribute
+     */
+    size_t append_array(const void *bytes, size_t size)
+    {
+        size_t offset = data.size();
+
+        if (!compress)
+        {
+            unsigned long long header = size;
+            append_bytes(&header, sizeof(header));
+            append_bytes(bytes, size);
+            return offset;
+        }
+
+#ifdef WITH_ZLIB
+        unsigned long long num_blocks = (size + VTU_COMPRESSION_BLOCK - 1) / VTU_COMPRESSION_BLOCK;
+        unsigned long long *header = (unsigned long long *)malloc(sizeof(unsigned long long) * (3 + num_blocks));
+        header[0] = num_blocks;
+        header[1] = VTU_COMPRESSION_BLOCK;
+        header[2] = num_blocks == 0 ? 0 : size - (num_blocks - 1) * VTU_COMPRESSION_BLOCK;
+
+        string blocks;
+        unsigned char *out = (unsigned char *)malloc(compressBound(VTU_COMPRESSION_BLOCK));
+        for (unsigned long long b = 0; b < num_blocks; b++)
+        {
+            uLong block_size = b + 1 < num_blocks ? VTU_COMPRESSION_BLOCK : header[2];
+            uLongf out_size = compressBound(VTU_COMPRESSION_BLOCK);
+            compress2(out, &out_size, (const unsigned char *)bytes + b * VTU_COMPRESSION_BLOCK, block_size, 1);
+            header[3 + b] = out_size;
+            blocks.append((const char *)out, out_size);
+        }
+
+        append_bytes(header, sizeof(unsigned long long) * (3 + num_blocks));
+        append_bytes(blocks.data(), blocks.size());
+
+        free(out);
+        free(header);
+#else
+        throw runtime_error("Compressed .vtu output needs a build with -DWITH_ZLIB -lz");
+#endif
+        return offset;
+    }
+
+    const string &get_data()
+    {
+        return data;
+    }
+};
+
+/**
+ * @brief Writes filename.vtu with the mesh and the given fields
+ *
+ * @param fields Result fields, e.g. temperature on the nodes and heat flux on the elements
+ * @param compress zlib compression of every array
+ */
+void write_vtu(string filename, Mesh *M, VtuField *fields, int num_fields, vtu_encoding encoding = VTU_RAW, bool compress = false)
+{
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+
+    VtuAppendedData appended(encoding, compress);
+    string point_data, cell_data;
+    char attributes[256];
+
+    for (int f = 0; f < num_fields; f++)
+    {
+        size_t count = (size_t)fields[f].components * (fields[f].on_nodes ? num_nodes : num_elements);
+        size_t offset = appended.append_array(fields[f].values, sizeof(float) * count);
+        snprintf(attributes, sizeof(attributes), "NumberOfComponents=\"%d\" format=\"appended\" offset=\"%zu\"/>\n",
+                 fields[f].components, offset);
+        string line = "        <DataArray type=\"Float32\" Name=\"" + fields[f].name + "\" " + attributes;
+        if (fields[f].on_nodes)
+            point_data += line;
+        else
+            cell_data += line;
+    }
+
+    // Points are interleaved x y z in VTK
+    float *points = (float *)malloc(sizeof(float) * 3 * (num_nodes > 0 ? num_nodes : 1));
+    for (int i = 0; i < num_nodes; i++)
+    {
+        points[3 * i] = x[i];
+        points[3 * i + 1] = y[i];
+        points[3 * i + 2] = z[i];
+    }
+    size_t points_offset = appended.append_array(points, sizeof(float) * 3 * num_nodes);
+    free(points);
+
+    int *offsets = (int *)malloc(sizeof(int) * (num_elements > 0 ? num_elements : 1));
+    unsigned char *types = (unsigned char *)malloc(num_elements > 0 ? num_elements : 1);
+    for (int e = 0; e < num_elements; e++)
+    {
+        offsets[e] = 4 * (e + 1);
+        types[e] = VTU_TETRA;
+    }
+    size_t connectivity_offset = appended.append_array(M->get_connectivity(), sizeof(int) * 4 * (size_t)num_elements);
+    size_t offsets_offset = appended.append_array(offsets, sizeof(int) * num_elements);
+    size_t types_offset = appended.append_array(types, num_elements);
+    free(offsets);
+    free(types);
+
+    string xml = "<?xml version=\"1.0\"?>\n"
+                 "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+    if (compress)
+        xml += " compressor=\"vtkZLibDataCompressor\"";
+    xml += ">\n  <UnstructuredGrid>\n";
+    xml += "    <Piece NumberOfPoints=\"" + to_string(num_nodes) + "\" NumberOfCells=\"" + to_string(num_elements) + "\">\n";
+    xml += "      <PointData>\n" + point_data + "      </PointData>\n";
+    xml += "      <CellData>\n" + cell_data + "      </CellData>\n";
+    xml += "      <Points>\n        <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" +
+           to_string(points_offset) + "\"/>\n      </Points>\n";
+    xml += "      <Cells>\n";
+    xml += "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\"" + to_string(connectivity_offset) + "\"/>\n";
+    xml += "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\"" + to_string(offsets_offset) + "\"/>\n";
+    xml += "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"" + to_string(types_offset) + "\"/>\n";
+    xml += "      </Cells>\n    </Piece>\n  </UnstructuredGrid>\n";
+    xml += string("  <AppendedData encoding=\"") + (encoding == VTU_BASE64 ? "base64" : "raw") + "\">\n   _";
+
+    string footer = "\n  </AppendedData>\n</VTKFile>\n";
+
+    string path = filename + ".vtu";
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == NULL)
+        throw runtime_error("Could not create " + path);
+
+    const string &data = appended.get_data();
+    bool written = fwrite(xml.data(), 1, xml.size(), file) == xml.size() &&
+                   fwrite(data.data(), 1, data.size(), file) == data.size() &&
+                   fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+    written = fclose(file) == 0 && written;
+
+    if (!written)
+        throw runtime_error("Could not write " + path);
+}
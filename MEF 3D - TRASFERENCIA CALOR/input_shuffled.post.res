@@ -0,0 +1,13 @@
+GiD Post Results File 1.0
+Result "Temperature" "Load Case 1" 1 Scalar OnNodes
+ComponentNames "T"
+Values
+1     565.364
+2     645.556
+3     350
+4     402.071
+5     350
+6     627.86
+7     328.57
+8     440.907
+End values
@@ -0,0 +1,284 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "geometry/mesh_generator.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "mef_utilities/mef_process.hpp"
+#include "gid/input_output.hpp"
+
+#define WARMUP 3          // samples run and discarded before measuring
+#define REPETITIONS 15    // measured samples
+#define MIN_SAMPLE_NS 2e6 // calls are batched until one sample takes this long
+
+float checksum = 0; // every result goes here and is printed, so the calls are not optimized away
+
+double elapsed_ns(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Fixed pseudo random values, the same in every build
+ */
+unsigned int seed = 12345;
+
+float next_random()
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) / 16777216.0f;
+}
+
+void fill_random(Matrix *A)
+{
+    for (int r = 0; r < A->get_nrows(); r++)
+        for (int c = 0; c < A->get_ncols(); c++)
+            A->set(next_random() - 0.5f, r, c);
+}
+
+/**
+ * @brief Symmetric and diagonally dominant, so Cholesky works on it like on K
+ */
+void fill_spd(Matrix *A, int n)
+{
+    for (int r = 0; r < n; r++)
+        for (int c = 0; c <= r; c++)
+        {
+            float value = next_random() - 0.5f;
+            A->set(value, r, c);
+            A->set(value, c, r);
+        }
+    for (int r = 0; r < n; r++)
+        A->set(n + next_random(), r, r);
+}
+
+/**
+ * @brief Times a kernel and prints one CSV row
+ *
+ * run(i) is the call i of a sample. Cheap kernels are batched: a sample runs
+ * run() as many times as needed to last MIN_SAMPLE_NS, calibrated during
+ * the warmup. Kernels that modify their input use setup(i) to rebuild it
+ * before each call, then every call is timed alone and setup is not timed.
+ *
+ * Reports ns per call: median and median absolute deviation (MAD) of the
+ * samples, and the fastest sample.
+ */
+template <class Setup, class Run>
+void benchmark(string kernel, string variant, int size, Setup setup, Run run, bool needs_setup)
+{
+    double samples[REPETITIONS];
+    long long calls = 1;
+
+    for (int s = -WARMUP; s < REPETITIONS; s++)
+    {
+        double ns = 0;
+        if (needs_setup)
+            for (long long i = 0; i < calls; i++)
+            {
+                setup(i);
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                run(i);
+                ns += elapsed_ns(start);
+            }
+        else
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (long long i = 0; i < calls; i++)
+                run(i);
+            ns = elapsed_ns(start);
+        }
+
+        if (s < 0)
+        {
+            // Calibration: grow the batch until a sample is long enough
+            while (ns * 2 < MIN_SAMPLE_NS && calls < (1LL << 30) && s == -WARMUP)
+            {
+                calls *= 2;
+                ns *= 2;
+            }
+            continue;
+        }
+        samples[s] = ns / calls;
+    }
+
+    sort(samples, samples + REPETITIONS);
+    double median = samples[REPETITIONS / 2];
+
+    double deviations[REPETITIONS];
+    for (int s = 0; s < REPETITIONS; s++)
+        deviations[s] = fabs(samples[s] - median);
+    sort(deviations, deviations + REPETITIONS);
+
+    cout << kernel << "," << variant << "," << size << "," << calls << "," << median << ","
+         << deviations[REPETITIONS / 2] << "," << samples[0] << "\n";
+}
+
+void no_setup(long long) {}
+
+/**
+ * @brief Kernel micro-benchmarks
+ *
+ * Fixed inputs (seeded random matrices and generated box meshes), WARMUP
+ * discarded samples and REPETITIONS measured ones. Output is CSV, one row
+ * per kernel, variant and size, times in ns per call:
+ *
+ *   kernel,variant,size,calls_per_sample,median_ns,mad_ns,min_ns
+ *
+ * To compare a replacement with the original, add a benchmark() line with
+ * the same kernel and size and another variant name: rows of both builds or
+ * both variants can then be joined on (kernel, variant, size).
+ *
+ * @example kernel_benchmark.exe > kernels.csv
+ */
+int main()
+{
+    cout << "kernel,variant,size,calls_per_sample,median_ns,mad_ns,min_ns\n";
+
+    // determinant: closed form up to 3x3, cofactor expansion above
+    int determinant_sizes[3] = {3, 4, 5};
+    for (int d = 0; d < 3; d++)
+    {
+        int n = determinant_sizes[d];
+        Matrix A(n, n);
+        fill_random(&A);
+        benchmark("determinant", "original", n, no_setup, [&](long long) { checksum += determinant(&A); }, false);
+        if (n == 3)
+            benchmark("determinant", "cofactor", n, no_setup, [&](long long) { checksum += determinant_auxiliar(&A); }, false);
+    }
+
+    int inverse_sizes[3] = {16, 64, 128};
+    for (int d = 0; d < 3; d++)
+    {
+        int n = inverse_sizes[d];
+        Matrix A(n, n), X(n, n);
+        fill_spd(&A, n);
+        benchmark("calculate_inverse", "original", n, no_setup, [&](long long) {
+            calculate_inverse(&A, n, &X);
+            checksum += X.get(0, 0); }, false);
+    }
+
+    // K T = b by the inverse (solve_system) against Cholesky in place
+    // (solve_system_cholesky), which overwrites K, so both start from a copy
+    for (int d = 0; d < 3; d++)
+    {
+        int n = inverse_sizes[d];
+        Matrix A(n, n), K(n, n);
+        Vector b(n), T(n);
+        fill_spd(&A, n);
+        for (int i = 0; i < n; i++)
+            b.set(next_random(), i);
+        benchmark("dense_solve", "calculate_inverse", n, [&](long long) { A.clone(&K); }, [&](long long) {
+            solve_system(&K, &b, &T);
+            checksum += T.get(0); }, true);
+        benchmark("dense_solve", "solve_system_cholesky", n, [&](long long) { A.clone(&K); }, [&](long long) {
+            solve_system_cholesky(&K, &b, &T);
+            checksum += T.get(0); }, true);
+    }
+
+    int product_sizes[3] = {4, 16, 64};
+    for (int d = 0; d < 3; d++)
+    {
+        int n = product_sizes[d];
+        Matrix A(n, n), B(n, n);
+        fill_random(&A);
+        fill_random(&B);
+        benchmark("product_matrix_by_matrix", "original", n, no_setup, [&](long long) {
+            Matrix R;
+            product_matrix_by_matrix(&A, &B, &R);
+            checksum += R.get(0, 0); }, false);
+    }
+
+    int vector_sizes[3] = {64, 256, 1024};
+    for (int d = 0; d < 3; d++)
+    {
+        int n = vector_sizes[d];
+        Matrix A(n, n);
+        Vector V(n), R(n);
+        fill_random(&A);
+        for (int i = 0; i < n; i++)
+            V.set(next_random(), i);
+        benchmark("product_matrix_by_vector", "original", n, no_setup, [&](long long) {
+            product_matrix_by_vector(&A, &V, n, n, &R);
+            checksum += R.get(0); }, false);
+    }
+
+    // Element kernels on a box of cubes split in 6 tetrahedra, Dirichlet on
+    // its bottom face, size = number of nodes
+    int mesh_sizes[2] = {4, 8};
+    for (int d = 0; d < 2; d++)
+    {
+        BoxMeshSpec spec = box_mesh_spec(mesh_sizes[d], mesh_sizes[d], mesh_sizes[d]);
+        spec.split = SPLIT_6_TETRAHEDRA;
+        spec.neumann_faces = 0;
+
+        Mesh M;
+        generate_box_mesh(&spec, &M);
+        int num_nodes = M.get_quantity(NUM_NODES);
+        int num_elements = M.get_quantity(NUM_ELEMENTS);
+
+        benchmark("create_local_K", "original", num_nodes, no_setup, [&](long long i) {
+            Matrix K;
+            create_local_K(&K, i % num_elements, &M);
+            checksum += K.get(0, 0); }, false);
+
+        benchmark("create_local_b", "original", num_nodes, no_setup, [&](long long i) {
+            Vector b;
+            create_local_b(&b, i % num_elements, &M);
+            checksum += b.get(0); }, false);
+
+        // Both at once against the compile time kernels of physics_kernels.hpp
+        benchmark("create_local_system", "original", num_nodes, no_setup, [&](long long i) {
+            Matrix K;
+            Vector b;
+            create_local_K(&K, i % num_elements, &M);
+            create_local_b(&b, i % num_elements, &M);
+            checksum += K.get(0, 0) + b.get(0); }, false);
+
+        HeatKernel heat(&M);
+        benchmark("create_local_system", "heat_kernel", num_nodes, no_setup, [&](long long i) {
+            Matrix K;
+            Vector b;
+            create_local_system(&heat, &K, &b, i % num_elements, &M);
+            checksum += K.get(0, 0) + b.get(0); }, false);
+
+        SecondEquationKernel second_equation(&M);
+        benchmark("create_local_system", "second_equation_kernel", num_nodes, no_setup, [&](long long i) {
+            Matrix K;
+            Vector b;
+            create_local_system(&second_equation, &K, &b, i % num_elements, &M);
+            checksum += K.get(0, 0) + b.get(0); }, false);
+
+        Matrix local_K(4, 4), K(num_nodes, num_nodes);
+        fill_random(&local_K);
+        K.init();
+        int *connectivity = M.get_connectivity();
+        benchmark("assembly_K", "original", num_nodes, no_setup, [&](long long i) {
+            int *n = &connectivity[4 * (i % num_elements)];
+            assembly_K(&K, &local_K, n[0], n[1], n[2], n[3]); }, false);
+        checksum += K.get(0, 0);
+
+        // Removes rows and columns of K and b, so both are rebuilt before each call
+        Matrix *K_copy = NULL;
+        Vector *b_copy = NULL;
+        Matrix K_full(num_nodes, num_nodes);
+        fill_spd(&K_full, num_nodes);
+        benchmark("apply_dirichlet_boundary_conditions", "original", num_nodes, [&](long long) {
+            delete K_copy;
+            delete b_copy;
+            K_copy = new Matrix(num_nodes, num_nodes);
+            b_copy = new Vector(num_nodes);
+            K_full.clone(K_copy);
+            b_copy->init(); }, [&](long long) {
+            apply_dirichlet_boundary_conditions(K_copy, b_copy, &M);
+            checksum += b_copy->get(0); }, true);
+        delete K_copy;
+        delete b_copy;
+    }
+
+    cerr << "checksum " << checksum << "\n";
+    return 0;
+}
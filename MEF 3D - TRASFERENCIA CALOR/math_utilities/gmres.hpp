@@ -0,0 +1,147 @@
+/**
+ * @file math_utilities/gmres.hpp
+ *
+ * @brief Restarted GMRES with right preconditioning
+ *
+ * Solves A x = b for a nonsymmetric A known only through products:
+ * A->apply(v, Av) and P->apply(v, z), with z about A^-1 v. Preconditioning
+ * from the right, A P^-1 u = b and x = P^-1 u, so the residual GMRES
+ * minimizes is the one of A x = b itself and the tolerance is on
+ * ||b - A x|| / ||b||.
+ *
+ * x is the initial guess on entry (warm start). If it is worse than zero,
+ * ||b - A x|| > ||b||, it is dropped.
+ *
+ * Modified Gram-Schmidt and Givens rotations, in double, restarted every
+ * GMRES_RESTART iterations. x is updated at the end of each cycle with one
+ * more preconditioner application, so only the Krylov basis is stored.
+ */
+#include <cmath>
+
+#define GMRES_RESTART 30
+
+inline double dot_product(double *u, double *v, int n)
+{
+    double sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += u[i] * v[i];
+    return sum;
+}
+
+/**
+ * @return Iterations, each one a product with A and one with P
+ *
+ * @param relative_residual Output, ||b - A x|| / ||b|| at the end
+ */
+template <class Operator, class Preconditioner>
+int gmres(Operator *A, Preconditioner *P, int n, double *b, double *x, double tolerance, int max_iterations,
+          double *relative_residual)
+{
+    int m = GMRES_RESTART;
+    double *V = (double *)malloc(sizeof(double) * (size_t)(m + 1) * n);
+    double *H = (double *)calloc((size_t)(m + 1) * m, sizeof(double)); // H[i * m + j]
+    double *cs = (double *)malloc(sizeof(double) * m);
+    double *sn = (double *)malloc(sizeof(double) * m);
+    double *g = (double *)malloc(sizeof(double) * (m + 1));
+    double *y = (double *)malloc(sizeof(double) * m);
+    double *z = (double *)malloc(sizeof(double) * n);
+    double *r = (double *)malloc(sizeof(double) * n);
+
+    double norm_b = sqrt(dot_product(b, b, n));
+    A->apply(x, r);
+    for (int i = 0; i < n; i++)
+        r[i] = b[i] - r[i];
+    double beta = sqrt(dot_product(r, r, n));
+    if (beta >= norm_b)
+    {
+        for (int i = 0; i < n; i++)
+            x[i] = 0, r[i] = b[i];
+        beta = norm_b;
+    }
+
+    int iterations = 0;
+    // b = 0 gives x = 0 with no iterations
+    while (iterations < max_iterations && beta > tolerance * norm_b)
+    {
+        for (int i = 0; i < n; i++)
+            V[i] = r[i] / beta;
+        g[0] = beta;
+
+        int k = 0;
+        while (k < m && iterations < max_iterations)
+        {
+            double *v = &V[(size_t)k * n], *w = &V[(size_t)(k + 1) * n];
+            P->apply(v, z);
+            A->apply(z, w);
+
+            for (int i = 0; i <= k; i++)
+            {
+                double *vi = &V[(size_t)i * n];
+                H[i * m + k] = dot_product(w, vi, n);
+                for (int j = 0; j < n; j++)
+                    w[j] -= H[i * m + k] * vi[j];
+            }
+            double h = sqrt(dot_product(w, w, n));
+            H[(k + 1) * m + k] = h;
+            if (h > 0)
+                for (int j = 0; j < n; j++)
+                    w[j] /= h;
+
+            // Previous rotations on the new column, then the one that zeroes h
+            for (int i = 0; i < k; i++)
+            {
+                double upper = H[i * m + k], lower = H[(i + 1) * m + k];
+                H[i * m + k] = cs[i] * upper + sn[i] * lower;
+                H[(i + 1) * m + k] = -sn[i] * upper + cs[i] * lower;
+            }
+            double diagonal = H[k * m + k];
+            double radius = sqrt(diagonal * diagonal + h * h);
+            cs[k] = radius > 0 ? diagonal / radius : 1;
+            sn[k] = radius > 0 ? h / radius : 0;
+            H[k * m + k] = radius;
+            H[(k + 1) * m + k] = 0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+
+            k++;
+            iterations++;
+            if (fabs(g[k]) <= tolerance * norm_b || h == 0)
+                break;
+        }
+
+        // x += P^-1 (V y), with H y = g
+        for (int i = k - 1; i >= 0; i--)
+        {
+            double sum = g[i];
+            for (int j = i + 1; j < k; j++)
+                sum -= H[i * m + j] * y[j];
+            y[i] = H[i * m + i] != 0 ? sum / H[i * m + i] : 0;
+        }
+        for (int j = 0; j < n; j++)
+        {
+            double sum = 0;
+            for (int i = 0; i < k; i++)
+                sum += V[(size_t)i * n + j] * y[i];
+            r[j] = sum;
+        }
+        P->apply(r, z);
+        for (int j = 0; j < n; j++)
+            x[j] += z[j];
+
+        A->apply(x, r);
+        for (int i = 0; i < n; i++)
+            r[i] = b[i] - r[i];
+        beta = sqrt(dot_product(r, r, n));
+    }
+
+    *relative_residual = norm_b > 0 ? beta / norm_b : 0;
+    free(V);
+    free(H);
+    free(cs);
+    free(sn);
+    free(g);
+    free(y);
+    free(z);
+    free(r);
+    return iterations;
+}
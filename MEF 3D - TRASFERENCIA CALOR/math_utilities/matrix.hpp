@@ -7,8 +7,13 @@ class Matrix {
 
         void create(){
             data = (float**) malloc(sizeof(float*) * nrows);
-            for(int r = 0; r < nrows; r++)
+            bool allocated = data != NULL;
+            for(int r = 0; r < nrows && allocated; r++){
                 data[r] = (float*) malloc(sizeof(float) * ncols);
+                allocated = data[r] != NULL || ncols == 0;
+            }
+            if(!allocated)
+                throw runtime_error("Not enough memory for a " + to_string(nrows) + " x " + to_string(ncols) + " matrix, see --dry-run");
         }
 
     public:
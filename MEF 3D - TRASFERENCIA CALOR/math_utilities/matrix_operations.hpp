@@ -13,6 +13,8 @@
 #include <cmath>
 #include "vector.hpp"
 #include "matrix.hpp"
+#include "skyline.hpp"
+#include "gmres.hpp"
 
 /**
  * @brief Calculates the product of a matrix and a scalar
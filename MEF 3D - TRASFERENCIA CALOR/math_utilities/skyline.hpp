@@ -0,0 +1,176 @@
+/**
+ * @file math_utilities/skyline.hpp
+ *
+ * @brief Symmetric matrix in profile (skyline) storage
+ *
+ * Only the lower triangle is stored, row by row: row i keeps the columns
+ * first[i] ... i, where first[i] is the column of its first nonzero.
+ * The Cholesky factor L = chol(K) has exactly the same profile, so it is
+ * computed in place and no memory is needed beyond the one of K.
+ *
+ *  - Storage: sum over rows of (i - first[i] + 1) values, the profile of K
+ *  - Factorization: sum over rows of (i - first[i])^2 / 2 operations
+ *
+ * Both depend on the numbering, see mef_utilities/sloan.hpp
+ */
+#include <cstring>
+
+class SkylineMatrix {
+    private:
+        int n;
+        int* first;       // first stored column of each row
+        long long* start; // start[i] = position of (i, first[i]) in data, start[n] = total size
+        float* data;
+
+    public:
+        SkylineMatrix(){
+            n = 0;
+            first = NULL;
+            start = NULL;
+            data = NULL;
+        }
+        ~SkylineMatrix(){
+            free(first);
+            free(start);
+            free(data);
+        }
+
+        /**
+         * @brief Allocates the profile, all values start at zero
+         *
+         * @param size Number of rows / columns
+         * @param first_column first_column[i] = first nonzero column of row i, i included
+         */
+        void set_profile(int size, int* first_column){
+            n = size;
+            first = (int*) malloc(sizeof(int) * n);
+            start = (long long*) malloc(sizeof(long long) * (n + 1));
+
+            start[0] = 0;
+            for(int i = 0; i < n; i++){
+                first[i] = first_column[i];
+                start[i + 1] = start[i] + (i - first[i] + 1);
+            }
+
+            data = (float*) calloc(start[n], sizeof(float));
+        }
+
+        int get_size(){
+            return n;
+        }
+
+        long long get_stored_values(){
+            return start[n];
+        }
+
+        /**
+         * @brief Sets every stored value to zero and keeps the profile, to
+         * assemble and factorize again a matrix with the same pattern
+         */
+        void clear(){
+            memset(data, 0, sizeof(float) * start[n]);
+        }
+
+        /**
+         * @brief Flops of factorize(): (i - first[i])^2 / 2 multiply-adds per row
+         */
+        double factorization_flops(){
+            double flops = 0;
+            for(int i = 0; i < n; i++)
+                flops += (double) (i - first[i]) * (i - first[i]);
+            return flops;
+        }
+
+        /**
+         * @brief Value at (row, col), any triangle, zero outside the profile
+         */
+        float get(int row, int col){
+            if(col > row)
+                swap(row, col);
+            if(col < first[row])
+                return 0;
+            return data[start[row] + col - first[row]];
+        }
+
+        /**
+         * @brief Accumulates value at (row, col), only the lower triangle is kept
+         * so entries with col > row are ignored
+         */
+        void add(float value, int row, int col){
+            if(col > row)
+                return;
+            data[start[row] + col - first[row]] += value;
+        }
+
+        void set(float value, int row, int col){
+            if(col > row)
+                swap(row, col);
+            data[start[row] + col - first[row]] = value;
+        }
+
+        /**
+         * @brief In place Cholesky factorization K = L*L^T
+         *
+         * Row by row: for each stored column j of row i
+         *
+         *  L(i,j) = (K(i,j) - sum L(i,k)*L(j,k)) / L(j,j),  k from max(first[i], first[j]) to j-1
+         *  L(i,i) = sqrt(K(i,i) - sum L(i,k)^2)
+         *
+         * Sums are accumulated in double. As in calculate_inverse(), a pivot that is
+         * not positive is replaced by a tiny value instead of aborting.
+         */
+        void factorize(){
+            for(int i = 0; i < n; i++){
+                float* row_i = &data[start[i]] - first[i]; // row_i[c] = L(i, c)
+
+                for(int j = first[i]; j < i; j++){
+                    float* row_j = &data[start[j]] - first[j];
+                    int k0 = first[i] > first[j] ? first[i] : first[j];
+
+                    double acc = row_i[j];
+                    for(int k = k0; k < j; k++)
+                        acc -= (double) row_i[k] * row_j[k];
+
+                    row_i[j] = acc / row_j[j];
+                }
+
+                double diagonal = row_i[i];
+                for(int k = first[i]; k < i; k++)
+                    diagonal -= (double) row_i[k] * row_i[k];
+
+                row_i[i] = diagonal <= 0 ? 0.000006 : sqrt(diagonal);
+            }
+        }
+
+        /**
+         * @brief Solves L*L^T x = b with the factorized matrix
+         *
+         * @param b Right hand side
+         * @param x Output, must have size n
+         */
+        void solve(Vector* b, Vector* x){
+            double* y = (double*) malloc(sizeof(double) * n);
+
+            // Forward substitution L y = b
+            for(int i = 0; i < n; i++){
+                float* row_i = &data[start[i]] - first[i];
+                double acc = b->get(i);
+                for(int k = first[i]; k < i; k++)
+                    acc -= row_i[k] * y[k];
+                y[i] = acc / row_i[i];
+            }
+
+            // Backward substitution L^T x = y, column oriented over the rows of L
+            for(int i = n - 1; i >= 0; i--){
+                float* row_i = &data[start[i]] - first[i];
+                y[i] /= row_i[i];
+                for(int k = first[i]; k < i; k++)
+                    y[k] -= row_i[k] * y[i];
+            }
+
+            for(int i = 0; i < n; i++)
+                x->set(y[i], i);
+
+            free(y);
+        }
+};
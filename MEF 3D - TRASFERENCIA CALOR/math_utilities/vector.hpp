@@ -7,6 +7,8 @@ class Vector {
 
         void create(){
                 data = (float*) malloc(sizeof(float) * size);
+                if(data == NULL && size > 0)
+                    throw runtime_error("Not enough memory for a vector of " + to_string(size) + " values");
         }
 
     public:
@@ -50,6 +52,11 @@ class Vector {
             return data[position];
         }
 
+        // Contiguous values, for writers that take the whole array
+        float* get_data(){
+            return data;
+        }
+
         void remove_row(int row){
             int neo_index = 0;
             float* neo_data = (float*) malloc(sizeof(float) * (size-1));
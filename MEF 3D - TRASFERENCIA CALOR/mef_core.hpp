@@ -0,0 +1,40 @@
+/**
+ * @file mef_core.hpp
+ *
+ * @brief Every header of the MEF 3D core, in the order they depend on each other
+ *
+ * This folder is the core shared by the three projects of the repository;
+ * each one has a main.cpp that includes this file and calls run_mef() with
+ * its element kernel (see mef_utilities/mef_program.hpp). One executable
+ * per equation, so each kernel is inlined into its own loop:
+ *
+ *  g++ -O2 -fopenmp main.cpp -o heat3d.exe
+ *  g++ -O2 -fopenmp "../MEF 3D - SEGUNDA ECUACION/main.cpp" -o second_equation.exe
+ *  g++ -O2 -fopenmp "../TAREA 2 - MEF 3D [MODIFICADO] - MONTICULOS MINIMOS/main.cpp" -o heap_skyline.exe
+ *  g++ -O2 -fopenmp kernel_benchmark.cpp -o kernel_benchmark.exe
+ *
+ * Compile time options (NODE_STORAGE, MESH_CACHE, PERF_COUNTERS, WITH_ZLIB,
+ * ...) must be defined before including it.
+ */
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "mef_utilities/mef_process.hpp"
+#include "mef_utilities/sloan.hpp"
+#include "gid/input_output.hpp"
+#include "gid/gid_project.hpp"
+#include "gid/post_binary.hpp"
+#include "gid/vtu_output.hpp"
+#include "gid/post_res_compare.hpp"
+#include "mef_utilities/run_report.hpp"
+#include "mef_utilities/memory_budget.hpp"
+#include "mef_utilities/transient.hpp"
+#include "mef_utilities/explicit_transient.hpp"
+#include "mef_utilities/conductivity.hpp"
+#include "mef_utilities/nonlinear.hpp"
+#include "mef_utilities/mef_program.hpp"
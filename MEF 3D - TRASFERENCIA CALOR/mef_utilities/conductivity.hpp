@@ -0,0 +1,171 @@
+/**
+ * @file mef_utilities/conductivity.hpp
+ *
+ * @brief Thermal conductivity as a function of temperature, k(T)
+ *
+ * Two forms, both with their derivative for Newton's method:
+ *
+ *  - table (--conductivity-table file): one "T k" pair per line, T
+ *    increasing, lines starting with # are comments. k is interpolated
+ *    linearly and kept constant beyond the first and last T.
+ *  - polynomial (--conductivity-poly c0,c1,c2,...): k = c0 + c1 T + c2 T^2 ...
+ *
+ * An element uses k at the mean temperature of its 4 nodes, see
+ * mef_utilities/nonlinear.hpp.
+ */
+
+enum conductivity_form
+{
+    CONDUCTIVITY_TABLE,
+    CONDUCTIVITY_POLYNOMIAL
+};
+
+class Conductivity
+{
+private:
+    int form;
+    int size;          // pairs of the table or coefficients of the polynomial
+    double *values;    // k of the table, coefficients of the polynomial
+    double *temperatures;
+
+    void allocate(int count)
+    {
+        size = count;
+        values = (double *)malloc(sizeof(double) * count);
+        temperatures = (double *)malloc(sizeof(double) * count);
+    }
+
+public:
+    Conductivity()
+    {
+        form = CONDUCTIVITY_POLYNOMIAL;
+        size = 0;
+        values = temperatures = NULL;
+    }
+    ~Conductivity()
+    {
+        free(values);
+        free(temperatures);
+    }
+
+    bool is_defined()
+    {
+        return size > 0;
+    }
+
+    /**
+     * @brief Reads the "T k" pairs of path
+     */
+    void read_table(string path)
+    {
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == NULL)
+            throw runtime_error("Could not open " + path);
+
+        char line[256];
+        int count = 0;
+        while (fgets(line, sizeof(line), file) != NULL)
+            if (line[0] != '#' && strspn(line, " \t\r\n") != strlen(line))
+                count++;
+
+        free(values);
+        free(temperatures);
+        allocate(count);
+        form = CONDUCTIVITY_TABLE;
+
+        rewind(file);
+        int pair = 0;
+        while (fgets(line, sizeof(line), file) != NULL && pair < count)
+        {
+            if (line[0] == '#' || strspn(line, " \t\r\n") == strlen(line))
+                continue;
+            if (sscanf(line, "%lf %lf", &temperatures[pair], &values[pair]) != 2)
+            {
+                fclose(file);
+                throw runtime_error(path + ": expected \"T k\" in line \"" + string(line) + "\"");
+            }
+            if (pair > 0 && temperatures[pair] <= temperatures[pair - 1])
+            {
+                fclose(file);
+                throw runtime_error(path + ": temperatures must be increasing");
+            }
+            pair++;
+        }
+        fclose(file);
+
+        if (pair == 0)
+            throw runtime_error(path + " has no \"T k\" pairs");
+        size = pair;
+    }
+
+    /**
+     * @brief Coefficients c0,c1,... separated by commas, false if invalid
+     */
+    bool parse_polynomial(string text)
+    {
+        int count = 1;
+        for (size_t c = 0; c < text.size(); c++)
+            count += text[c] == ',';
+
+        free(values);
+        free(temperatures);
+        allocate(count);
+        form = CONDUCTIVITY_POLYNOMIAL;
+
+        const char *position = text.c_str();
+        for (int i = 0; i < count; i++)
+        {
+            char *end;
+            values[i] = strtod(position, &end);
+            if (end == position || (*end != ',' && *end != '\0'))
+            {
+                size = 0;
+                return false;
+            }
+            position = end + 1;
+        }
+        return true;
+    }
+
+    double value(double T)
+    {
+        if (form == CONDUCTIVITY_POLYNOMIAL)
+        {
+            double k = 0;
+            for (int i = size - 1; i >= 0; i--)
+                k = k * T + values[i];
+            return k;
+        }
+
+        if (T <= temperatures[0])
+            return values[0];
+        if (T >= temperatures[size - 1])
+            return values[size - 1];
+        int i = 0;
+        while (temperatures[i + 1] < T)
+            i++;
+        double w = (T - temperatures[i]) / (temperatures[i + 1] - temperatures[i]);
+        return values[i] + w * (values[i + 1] - values[i]);
+    }
+
+    /**
+     * @brief dk/dT, 0 beyond the ends of a table
+     */
+    double derivative(double T)
+    {
+        if (form == CONDUCTIVITY_POLYNOMIAL)
+        {
+            double dk = 0;
+            for (int i = size - 1; i >= 1; i--)
+                dk = dk * T + i * values[i];
+            return dk;
+        }
+
+        if (T <= temperatures[0] || T >= temperatures[size - 1])
+            return 0;
+        int i = 0;
+        while (temperatures[i + 1] < T)
+            i++;
+        return (values[i + 1] - values[i]) / (temperatures[i + 1] - temperatures[i]);
+    }
+};
@@ -0,0 +1,271 @@
+/**
+ * @file mef_utilities/explicit_transient.hpp
+ *
+ * @brief Explicit time integration with the lumped heat capacity
+ *
+ * With the lumped C of transient.hpp, diagonal with m_i the sum of
+ * rho*c*V/4 over the elements of node i,
+ *
+ *  dT/dt = f(T) = C^-1 (b - K T)
+ *
+ * needs no linear system at all:
+ *
+ *  - euler: T(t + dt) = T + dt f(T)
+ *  - rk2 (Heun): T* = T + dt f(T), T(t + dt) = T + dt/2 (f(T) + f(T*))
+ *
+ * Both are stable while dt <= 2 / lambda_max(C^-1 K). By Gershgorin every
+ * eigenvalue is at most max_i sum_j |K_ij| / m_i; K of an element grows as
+ * k*V/h^2 and its m as rho*c*V, so this is the usual rho*c*h^2/k bound of
+ * the smallest element. stable_time_step() gives EXPLICIT_SAFETY times it.
+ *
+ * K T is applied element by element, there is no global K:
+ *
+ *  - elements: y_e = K_e T_e, the 10 values of each symmetric K_e are kept
+ *    as a structure of arrays, vectorized across elements. They are copied
+ *    once from the local systems, so the geometry of create_local_systems()
+ *    is reused.
+ *  - nodes: each node adds the y_e of its elements, in the order of the
+ *    node to element graph, and updates its own T in the same loop.
+ *
+ * Both sweeps are parallel with no atomics, and the result does not depend
+ * on the number of threads. Dirichlet nodes have m_i^-1 = 0, so they keep
+ * their value.
+ */
+
+#define EXPLICIT_SAFETY 0.9
+
+/**
+ * @brief Position of K(r, c), r <= c, among the 10 stored values of K_e
+ */
+static const int explicit_slots[4][4] = {{0, 1, 2, 3}, {1, 4, 5, 6}, {2, 5, 7, 8}, {3, 6, 8, 9}};
+
+class LumpedExplicitSystem
+{
+private:
+    int num_nodes, num_elements;
+    int *connectivity;
+    int *incidence_offset; // node to element graph of the mesh
+    int *incidence_slot;   // position in y of each element of a node: r * num_elements + e
+    float *stiffness;      // value s of element e at stiffness[s * num_elements + e]
+    float *y;              // K_e T_e, corner r of element e at y[r * num_elements + e]
+    float *load;           // b with the Neumann conditions
+    float *inverse_mass;   // 1 / m_i, 0 for Dirichlet nodes
+
+public:
+    LumpedExplicitSystem(Mesh *M, Matrix *Ks, Vector *bs, float capacity)
+    {
+        num_nodes = M->get_quantity(NUM_NODES);
+        num_elements = M->get_quantity(NUM_ELEMENTS);
+        connectivity = M->get_connectivity();
+
+        MeshGraph *G = M->get_graph();
+        incidence_offset = G->get_element_offsets();
+        int *incidence_element = G->get_element_indices();
+
+        stiffness = (float *)malloc(sizeof(float) * 10 * num_elements);
+        y = (float *)malloc(sizeof(float) * 4 * num_elements);
+        load = (float *)calloc(num_nodes, sizeof(float));
+        inverse_mass = (float *)calloc(num_nodes, sizeof(float));
+        incidence_slot = (int *)malloc(sizeof(int) * (4 * num_elements > 0 ? 4 * num_elements : 1));
+
+        float *capacities = (float *)malloc(sizeof(float) * num_elements);
+        calculate_element_capacities(M, capacity, capacities);
+
+        float *mass = inverse_mass;
+        for (int e = 0; e < num_elements; e++)
+        {
+            for (int r = 0; r < 4; r++)
+            {
+                for (int c = r; c < 4; c++)
+                    stiffness[explicit_slots[r][c] * num_elements + e] = Ks[e].get(r, c);
+                mass[connectivity[4 * e + r]] += capacities[e] / 4;
+                load[connectivity[4 * e + r]] += bs[e].get(r);
+            }
+        }
+        free(capacities);
+
+        for (int i = 0; i < num_nodes; i++)
+        {
+            inverse_mass[i] = mass[i] > 0 ? 1 / mass[i] : 0;
+            for (int p = incidence_offset[i]; p < incidence_offset[i + 1]; p++)
+            {
+                int e = incidence_element[p], r = 0;
+                while (r < 3 && connectivity[4 * e + r] != i)
+                    r++;
+                incidence_slot[p] = r * num_elements + e;
+            }
+        }
+
+        for (int c = 0; c < M->get_quantity(NUM_NEUMANN); c++)
+        {
+            Condition *cond = M->get_neumann_condition(c);
+            load[cond->get_node()->get_ID() - 1] += cond->get_value();
+        }
+        for (int c = 0; c < M->get_quantity(NUM_DIRICHLET); c++)
+            inverse_mass[M->get_dirichlet_condition(c)->get_node()->get_ID() - 1] = 0;
+    }
+
+    ~LumpedExplicitSystem()
+    {
+        free(stiffness);
+        free(y);
+        free(load);
+        free(inverse_mass);
+        free(incidence_slot);
+    }
+
+    /**
+     * @brief EXPLICIT_SAFETY * 2 / (max over free nodes of sum_j |K_ij| / m_i)
+     */
+    double stable_time_step()
+    {
+        double largest = 0;
+        for (int i = 0; i < num_nodes; i++)
+        {
+            if (inverse_mass[i] == 0)
+                continue;
+            double row = 0;
+            for (int p = incidence_offset[i]; p < incidence_offset[i + 1]; p++)
+            {
+                int r = incidence_slot[p] / num_elements, e = incidence_slot[p] % num_elements;
+                for (int c = 0; c < 4; c++)
+                    row += fabs(stiffness[explicit_slots[r < c ? r : c][r < c ? c : r] * num_elements + e]);
+            }
+            largest = row * inverse_mass[i] > largest ? row * inverse_mass[i] : largest;
+        }
+        return largest > 0 ? EXPLICIT_SAFETY * 2 / largest : HUGE_VAL;
+    }
+
+    /**
+     * @brief y_e = K_e T_e of every element
+     */
+    void element_sweep(float *T)
+    {
+        int n = num_elements;
+        float *k = stiffness;
+        int *nodes = connectivity;
+
+#pragma omp parallel for simd schedule(static)
+        for (int e = 0; e < n; e++)
+        {
+            float t0 = T[nodes[4 * e]], t1 = T[nodes[4 * e + 1]], t2 = T[nodes[4 * e + 2]], t3 = T[nodes[4 * e + 3]];
+            y[e] = k[e] * t0 + k[n + e] * t1 + k[2 * n + e] * t2 + k[3 * n + e] * t3;
+            y[n + e] = k[n + e] * t0 + k[4 * n + e] * t1 + k[5 * n + e] * t2 + k[6 * n + e] * t3;
+            y[2 * n + e] = k[2 * n + e] * t0 + k[5 * n + e] * t1 + k[7 * n + e] * t2 + k[8 * n + e] * t3;
+            y[3 * n + e] = k[3 * n + e] * t0 + k[6 * n + e] * t1 + k[8 * n + e] * t2 + k[9 * n + e] * t3;
+        }
+    }
+
+    /**
+     * @brief f_i = (b_i - (K T)_i) / m_i, with y of the last element_sweep()
+     */
+    inline float rate(int i)
+    {
+        float sum = 0;
+        for (int p = incidence_offset[i]; p < incidence_offset[i + 1]; p++)
+            sum += y[incidence_slot[p]];
+        return (load[i] - sum) * inverse_mass[i];
+    }
+
+    int get_num_nodes()
+    {
+        return num_nodes;
+    }
+
+    /**
+     * @brief Flops of an element_sweep() and the rate() of every node
+     */
+    double sweep_flops()
+    {
+        return 32.0 * num_elements + 4.0 * num_elements + 2.0 * num_nodes;
+    }
+};
+
+/**
+ * @brief Explicit integration from T = settings->initial at t = 0 with the
+ * lumped C, the output steps written to filename.post.res
+ *
+ * settings->time_step 0 means the stable time step.
+ *
+ * @param T_full Output, value at the last step of node with ID i at position i - 1
+ */
+void solve_explicit(Mesh *M, Matrix *local_Ks, Vector *local_bs, TransientSettings *settings, string filename,
+                    RunReport *report, Vector *T_full, SolverRecord *solver)
+{
+    report->phase("lumped_mass");
+    log_message(LOG_SUMMARY, "Lumping heat capacity...\n");
+    LumpedExplicitSystem system(M, local_Ks, local_bs, settings->capacity);
+    int n = system.get_num_nodes();
+
+    double stable = system.stable_time_step();
+    if (settings->time_step == 0)
+        settings->time_step = stable;
+    else if (settings->time_step > stable)
+        log_message(LOG_SUMMARY, "Warning: time step " + to_string(settings->time_step) +
+                                     " is above the stable estimate " + to_string(stable) + "\n");
+
+    report->phase("time_steps");
+    log_message(LOG_SUMMARY, "Integrating " + to_string(settings->steps) + " explicit " +
+                                 explicit_names[settings->scheme] + " steps of " + to_string(settings->time_step) +
+                                 " (stable estimate " + to_string(stable) + ")...\n");
+
+    float *T = T_full->get_data();
+    float *rates = (float *)malloc(sizeof(float) * n);
+    float *predicted = (float *)malloc(sizeof(float) * n);
+    float dt = settings->time_step;
+
+    for (int i = 0; i < n; i++)
+        T[i] = settings->initial;
+    for (int c = 0; c < M->get_quantity(NUM_DIRICHLET); c++)
+    {
+        Condition *cond = M->get_dirichlet_condition(c);
+        T[cond->get_node()->get_ID() - 1] = cond->get_value();
+    }
+
+    PostResStream output(filename);
+    output.write_step(T_full, M, 0);
+
+    ProgressBar progress("Time steps", settings->steps);
+    for (int step = 1; step <= settings->steps; step++)
+    {
+        progress.update(step - 1);
+        if (settings->scheme == EXPLICIT_EULER)
+        {
+            PerfRegion region("explicit_euler_step", system.sweep_flops() + 2.0 * n);
+            system.element_sweep(T);
+            // Every y_e is already computed from the old T, so T is updated in place
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; i++)
+                T[i] += dt * system.rate(i);
+        }
+        else
+        {
+            PerfRegion region("explicit_rk2_step", 2 * system.sweep_flops() + 6.0 * n);
+            system.element_sweep(T);
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; i++)
+            {
+                rates[i] = system.rate(i);
+                predicted[i] = T[i] + dt * rates[i];
+            }
+
+            system.element_sweep(predicted);
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; i++)
+                T[i] += dt / 2 * (rates[i] + system.rate(i));
+        }
+
+        if (is_output_step(settings, step))
+            output.write_step(T_full, M, step * settings->time_step);
+    }
+    progress.finish();
+    output.close();
+    report->end_phase();
+
+    free(rates);
+    free(predicted);
+
+    solver->method = string("explicit_") + explicit_names[settings->scheme];
+    solver->unknowns = n;
+    solver->nonzeros = assembled_nonzeros(M);
+}
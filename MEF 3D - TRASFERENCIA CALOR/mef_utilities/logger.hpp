@@ -0,0 +1,121 @@
+/**
+ * @file mef_utilities/logger.hpp
+ *
+ * @brief Console messages with verbosity levels
+ *
+ *  - LOG_QUIET: nothing but errors
+ *  - LOG_SUMMARY: one line per phase, a progress bar for the long loops and
+ *    summary statistics of the mesh and the result (default)
+ *  - LOG_DEBUG: also the inner steps and the full mesh listing of
+ *    Mesh::report()
+ *
+ * Messages go to cout, progress bars to cerr so they never end up in a
+ * redirected log. Printing once per element made stdout the bottleneck on
+ * large meshes, so the bars are redrawn at most every
+ * LOG_PROGRESS_INTERVAL_MS milliseconds.
+ */
+#include <iostream>
+#include <string>
+#include <chrono>
+
+enum log_level
+{
+    LOG_QUIET,
+    LOG_SUMMARY,
+    LOG_DEBUG
+};
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_SUMMARY
+#endif
+
+#ifndef LOG_PROGRESS_INTERVAL_MS
+#define LOG_PROGRESS_INTERVAL_MS 200
+#endif
+
+#define LOG_PROGRESS_WIDTH 30 // characters of the bar
+
+log_level current_log_level = LOG_LEVEL;
+
+void set_log_level(log_level level)
+{
+    current_log_level = level;
+}
+
+bool log_enabled(log_level level)
+{
+    return current_log_level >= level && current_log_level != LOG_QUIET;
+}
+
+/**
+ * @brief Prints a whole message if the current level includes it
+ */
+void log_message(log_level level, string message)
+{
+    if (log_enabled(level))
+        cout << message << "\n";
+}
+
+/**
+ * @brief Progress bar of one phase
+ *
+ * update() only compares a counter in the common case: the clock is read
+ * every 1/1000 of the work and the bar redrawn when the interval passed.
+ */
+class ProgressBar
+{
+private:
+    string phase;
+    long long total;
+    long long next_check;
+    long long step;
+    bool enabled;
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point last_draw;
+
+    void draw(long long done)
+    {
+        int filled = total > 0 ? (int)(LOG_PROGRESS_WIDTH * done / total) : LOG_PROGRESS_WIDTH;
+        string bar(filled, '#');
+        bar.resize(LOG_PROGRESS_WIDTH, '.');
+        cerr << "\r\t" << phase << " [" << bar << "] " << done << "/" << total << flush;
+    }
+
+public:
+    ProgressBar(string phase_name, long long total_work)
+    {
+        phase = phase_name;
+        total = total_work;
+        step = total / 1000 > 0 ? total / 1000 : 1;
+        next_check = 0;
+        enabled = log_enabled(LOG_SUMMARY) && total > 0;
+        start = last_draw = chrono::steady_clock::now();
+    }
+
+    void update(long long done)
+    {
+        if (!enabled || done < next_check)
+            return;
+        next_check = done + step;
+
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (chrono::duration_cast<chrono::milliseconds>(now - last_draw).count() >= LOG_PROGRESS_INTERVAL_MS)
+        {
+            last_draw = now;
+            draw(done);
+        }
+    }
+
+    /**
+     * @brief Draws the full bar once, only if it was shown at all
+     */
+    void finish()
+    {
+        if (enabled && last_draw != start)
+        {
+            draw(total);
+            cerr << "\n";
+        }
+        enabled = false;
+    }
+};
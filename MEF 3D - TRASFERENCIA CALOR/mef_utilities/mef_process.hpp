@@ -31,6 +31,9 @@
 #include <cmath>
 using namespace std;
 
+#include "perf_counters.hpp"
+#include "physics_kernels.hpp"
+
 float calculate_local_volume(float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3, float x4, float y4, float z4);
 float calculate_local_volume(float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3, float x4, float y4, float z4)
 {
@@ -312,30 +315,28 @@ void create_local_b(Vector *b,int element_id, Mesh *M)
 
 }
 
+/**
+ * @brief Local K and b of every element, with the element kernel of Physics
+ * (see physics_kernels.hpp)
+ *
+ * create_local_K() and create_local_b() compute the same heat transfer
+ * system through Matrix products, they are kept as the reference the
+ * kernels are checked and benchmarked against (kernel_benchmark.cpp).
+ */
+template <class Physics>
 void create_local_systems(Matrix *Ks, Vector *bs,int num_elements, Mesh *M)
 {
+    Physics physics(M);
+    ProgressBar progress("Local systems", num_elements);
+    PerfRegion region("create_local_systems", 150.0 * num_elements); // two determinants, A, A*B and G
 
     //Creates the local system for each element 
     for (int e = 0; e < num_elements; e++)
     {
-
-        cout << "\tCreating local system for Element " << e + 1 << "...\n\n";
-        /**
-         * @brief Create a local K object
-         * Creating the local K means calculate each piece of the formula for this element
-         * [((k*V)/(J*J))((B^T)(A^T)(A*B))] 
-         * and multiply
-         * the resulting matrices
-         */
-        create_local_K(&Ks[e], e, M);
-        
-        /**
-         * @brief Create a local b object
-         * Creating the local b means calculate the jacobian (J) for each element and replace 
-         * it in the formula (Q*J/24)[1,1,1,1]
-         */
-        create_local_b(&bs[e], e, M);
+        progress.update(e);
+        create_local_system(&physics, &Ks[e], &bs[e], e, M);
     }
+    progress.finish();
 }
 
 
@@ -387,11 +388,14 @@ void assembly(Matrix *K, Vector *b, Matrix *Ks, Vector *bs,int num_elements, Mes
     b->init();
 
 
+    ProgressBar progress("Assembly", num_elements);
+    PerfRegion region("assembly", 20.0 * num_elements); // 16 + 4 additions per element
+
     //For each element
     for (int e = 0; e < num_elements; e++)
     {
         // 3D MEF CHANGE
-        cout << "\tAssembling for Element " << e + 1 << "...\n\n";
+        progress.update(e);
        int index1 = M->get_element(e)->get_node1()->get_ID() - 1;
        int index2 = M->get_element(e)->get_node2()->get_ID() - 1;
        int index3 = M->get_element(e)->get_node3()->get_ID() - 1;
@@ -400,6 +404,7 @@ void assembly(Matrix *K, Vector *b, Matrix *Ks, Vector *bs,int num_elements, Mes
         assembly_K(K, &Ks[e], index1, index2, index3, index4);
         assembly_b(b, &bs[e], index1, index2, index3, index4);
     }
+    progress.finish();
 }
 
 void apply_neumann_boundary_conditions(Vector *b, Mesh *M)
@@ -475,17 +480,368 @@ void merge_results_with_dirichlet(Vector *T, Vector *Tf, int n, Mesh *M)
     }
 }
 
+/**
+ * @brief Summary of the temperature field, in place of printing it
+ */
+void report_results(Vector *T)
+{
+    int n = T->get_size();
+    if (!log_enabled(LOG_SUMMARY) || n == 0)
+        return;
+
+    float min_T = T->get(0), max_T = T->get(0);
+    double sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        float value = T->get(i);
+        min_T = value < min_T ? value : min_T;
+        max_T = value > max_T ? value : max_T;
+        sum += value;
+    }
+    cout << "Temperature: min " << min_T << ", max " << max_T << ", mean " << sum / n << "\n\n";
+}
+
 void solve_system(Matrix *K, Vector *b, Vector *T)
 {
     int n = K->get_nrows();
 
     Matrix Kinv(n, n);
-    cout << n << "\n\n\n";
+    log_message(LOG_DEBUG, "\tUnknowns: " + to_string(n));
     //K->show();
-    cout << "\tCalculating inverse of global matrix K...\n\n";
-    calculate_inverse(K, n, &Kinv);
+    log_message(LOG_DEBUG, "\tCalculating inverse of global matrix K...");
+    {
+        // Cholesky n^3/3, inverse of L n^3/3, back substitution n^3
+        PerfRegion region("calculate_inverse", 5.0 / 3.0 * n * n * (double)n);
+        calculate_inverse(K, n, &Kinv);
+    }
 
     //Kinv.show();
-    cout << "\tPerforming final calculation...\n\n";
-    product_matrix_by_vector(&Kinv, b, n, n, T);
+    log_message(LOG_DEBUG, "\tPerforming final calculation...");
+    {
+        PerfRegion region("product_matrix_by_vector", 2.0 * n * n);
+        product_matrix_by_vector(&Kinv, b, n, n, T);
+    }
+}
+
+/**
+ * @brief Solves K*T = b by Cholesky factorization, without the inverse
+ *
+ * K = L L^T is factorized in place: L goes to the strict lower triangle of
+ * K and its diagonal to a separate array, so the upper triangle and the
+ * diagonal of K are kept (relative_residual() only reads those). Then
+ * L y = b and L^T T = y are solved by substitution.
+ *
+ * n^3/3 flops and no extra n x n matrix, against 5n^3/3 and three extra
+ * matrices of solve_system(). Sums are in double. Like calculate_inverse(),
+ * a non positive pivot is replaced by 0.000006.
+ */
+void solve_system_cholesky(Matrix *K, Vector *b, Vector *T)
+{
+    int n = K->get_nrows();
+    float *diagonal = (float *)malloc(sizeof(float) * (n > 0 ? n : 1));
+    double *y = (double *)malloc(sizeof(double) * (n > 0 ? n : 1));
+    if (diagonal == NULL || y == NULL)
+        throw runtime_error("Not enough memory for the Cholesky factor of " + to_string(n) + " unknowns");
+
+    log_message(LOG_DEBUG, "\tUnknowns: " + to_string(n));
+    log_message(LOG_DEBUG, "\tFactorizing global matrix K...");
+    {
+        PerfRegion region("cholesky_factorization", n * (double)n * n / 3.0);
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j <= i; j++)
+            {
+                // Row i of L is built left to right, row j is already done
+                double sum = K->get(i, j);
+                for (int k = 0; k < j; k++)
+                    sum -= (double)K->get(i, k) * K->get(j, k);
+
+                if (j < i)
+                    K->set((float)(sum / diagonal[j]), i, j);
+                else
+                    diagonal[i] = sum <= 0 ? 0.000006f : (float)sqrt(sum);
+            }
+        }
+    }
+
+    log_message(LOG_DEBUG, "\tSolving triangular systems...");
+    {
+        PerfRegion region("triangular_solve", 2.0 * n * n);
+        for (int i = 0; i < n; i++)
+        {
+            double sum = b->get(i);
+            for (int k = 0; k < i; k++)
+                sum -= (double)K->get(i, k) * y[k];
+            y[i] = sum / diagonal[i];
+        }
+
+        // L^T T = y, by rows of L: once T[i] is known it leaves the rows above
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double value = y[i] / diagonal[i];
+            T->set((float)value, i);
+            for (int k = 0; k < i; k++)
+                y[k] -= K->get(i, k) * value;
+        }
+    }
+
+    free(diagonal);
+    free(y);
+}
+
+/**
+ * @name Profile (skyline) solution path
+ *
+ * Same steps as the dense path (assembly, Neumann, Dirichlet, solve, merge)
+ * but K is stored in a SkylineMatrix numbered with a node permutation,
+ * usually the Sloan ordering of mef_utilities/sloan.hpp.
+ * Row / column of node with ID i is permutation[i - 1].
+ */
+///@{
+
+/**
+ * @brief Allocates K with the profile given by the mesh graph, all zeros
+ */
+void allocate_profile(SkylineMatrix *K, Mesh *M, int *permutation)
+{
+    MeshGraph *G = M->get_graph();
+    int n = G->get_num_nodes();
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+
+    // First nonzero column of each row of K, after renumbering
+    int *first = (int *)malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++)
+    {
+        int row = permutation[i];
+        first[row] = row;
+        for (int p = offset[i]; p < offset[i + 1]; p++)
+            if (permutation[index[p]] < first[row])
+                first[row] = permutation[index[p]];
+    }
+
+    K->set_profile(n, first);
+    free(first);
+}
+
+/**
+ * @brief Allocates K with the profile given by the mesh graph and assembles
+ * every local system into it
+ */
+void assembly(SkylineMatrix *K, Vector *b, Matrix *Ks, Vector *bs, int num_elements, Mesh *M, int *permutation)
+{
+    allocate_profile(K, M, permutation);
+    b->init();
+    ProgressBar progress("Assembly", num_elements);
+    PerfRegion region("assembly", 20.0 * num_elements);
+
+    for (int e = 0; e < num_elements; e++)
+    {
+        progress.update(e);
+        int nodes[4];
+        MeshGraph::get_element_nodes(M->get_element(e), nodes);
+
+        for (int r = 0; r < 4; r++)
+        {
+            int row = permutation[nodes[r]];
+            for (int c = 0; c < 4; c++)
+                K->add(Ks[e].get(r, c), row, permutation[nodes[c]]);
+            b->add(bs[e].get(r), row);
+        }
+    }
+    progress.finish();
+}
+
+void apply_neumann_boundary_conditions(Vector *b, Mesh *M, int *permutation)
+{
+    int num_conditions = M->get_quantity(NUM_NEUMANN);
+
+    for (int c = 0; c < num_conditions; c++)
+    {
+        Condition *cond = M->get_neumann_condition(c);
+
+        int index = permutation[cond->get_node()->get_ID() - 1];
+        b->add(cond->get_value(), index);
+    }
+}
+
+/**
+ * @brief Dirichlet conditions without removing rows and columns
+ *
+ * The profile can not shrink, so instead of removing the row and column of
+ * a fixed node, its column is moved to the right hand side of every
+ * neighbour row and then the row and column are replaced by the identity,
+ * with the condition value in b. The solution of that row is the value itself.
+ */
+void apply_dirichlet_boundary_conditions(SkylineMatrix *K, Vector *b, Mesh *M, int *permutation)
+{
+    MeshGraph *G = M->get_graph();
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+    int num_conditions = M->get_quantity(NUM_DIRICHLET);
+
+    for (int c = 0; c < num_conditions; c++)
+    {
+        Condition *cond = M->get_dirichlet_condition(c);
+
+        int node = cond->get_node()->get_ID() - 1;
+        int fixed = permutation[node];
+        float cond_value = cond->get_value();
+
+        for (int p = offset[node]; p < offset[node + 1]; p++)
+        {
+            int row = permutation[index[p]];
+            b->add(-cond_value * K->get(row, fixed), row);
+            K->set(0, row, fixed);
+        }
+
+        K->set(1, fixed, fixed);
+        b->set(cond_value, fixed);
+    }
+}
+
+/**
+ * @brief Solves K*T = b with the Cholesky factorization of the profile and
+ * returns T in the original node numbering
+ *
+ * @param T_full Output, temperature of node with ID i at position i - 1
+ */
+void solve_system(SkylineMatrix *K, Vector *b, Vector *T_full, int *permutation)
+{
+    int n = K->get_size();
+    Vector T(n);
+
+    log_message(LOG_DEBUG, "\tFactorizing global matrix K (" + to_string(K->get_stored_values()) + " stored values)...");
+    {
+        PerfRegion region("skyline_factorization", K->factorization_flops());
+        K->factorize();
+    }
+
+    log_message(LOG_DEBUG, "\tPerforming final calculation...");
+    {
+        PerfRegion region("skyline_solve", 4.0 * K->get_stored_values());
+        K->solve(b, &T);
+    }
+
+    for (int i = 0; i < n; i++)
+        T_full->set(T.get(permutation[i]), i);
+}
+///@}
+
+/**
+ * @brief Solvers of the global system, chosen with --solver
+ *
+ *  - SOLVER_CHOLESKY_INVERSE: solve_system(), the inverse of K
+ *  - SOLVER_CHOLESKY: solve_system_cholesky(), dense K factorized in place
+ *  - SOLVER_SKYLINE: the profile path above, with the Sloan ordering
+ */
+enum solver_method
+{
+    SOLVER_CHOLESKY_INVERSE,
+    SOLVER_CHOLESKY,
+    SOLVER_SKYLINE,
+    NUM_SOLVERS
+};
+
+static const char *solver_names[NUM_SOLVERS] = {"cholesky_inverse", "cholesky", "skyline"};
+
+/**
+ * @brief Solver of a name of solver_names, -1 if there is none
+ */
+int parse_solver(string name)
+{
+    for (int s = 0; s < NUM_SOLVERS; s++)
+        if (name == solver_names[s])
+            return s;
+    return -1;
+}
+
+/**
+ * @brief Nonzeros of the assembled K: the diagonal plus every pair of nodes
+ * that share an element
+ */
+long long assembled_nonzeros(Mesh *M)
+{
+    int n = M->get_quantity(NUM_NODES);
+    return (long long)n + M->get_graph()->get_node_offsets()[n];
+}
+
+/**
+ * @brief Relative residual ||K*T - b|| / ||b|| of the solved system
+ *
+ * K is symmetric, so only its diagonal and upper triangle are read: they
+ * are still intact after solve_system_cholesky().
+ */
+double relative_residual(Matrix *K, Vector *b, Vector *T)
+{
+    int n = K->get_nrows();
+    double residual = 0, norm_b = 0;
+
+    for (int r = 0; r < n; r++)
+    {
+        double row = -b->get(r);
+        for (int c = 0; c < n; c++)
+            row += (double)(c >= r ? K->get(r, c) : K->get(c, r)) * T->get(c);
+        residual += row * row;
+        norm_b += (double)b->get(r) * b->get(r);
+    }
+    return norm_b > 0 ? sqrt(residual / norm_b) : sqrt(residual);
+}
+
+/**
+ * @brief Heat flux q = -k grad(T) of every element, for the output
+ *
+ * T is linear inside a tetrahedron, so grad(T) is constant per element.
+ * With J the jacobian of calculate_local_jacobian() (columns = edges from
+ * node 1) and B of calculate_B():
+ *
+ *  J^T grad(T) = B [T1, T2, T3, T4]
+ *
+ * The 3x3 system is solved by Cramer's rule in double, directly on the
+ * structure of arrays of the mesh.
+ *
+ * @param T Temperature of every node, Dirichlet nodes included
+ * @param flux Output, 3 values (qx, qy, qz) per element
+ */
+void calculate_heat_flux(Vector *T, Mesh *M, float *flux)
+{
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    float k = M->get_problem_data(THERMAL_CONDUCTIVITY);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+    int *connectivity = M->get_connectivity();
+
+    #pragma omp parallel for
+    for (int e = 0; e < num_elements; e++)
+    {
+        int *nodes = &connectivity[4 * e];
+
+        // Rows of J^T: edge vectors from node 1
+        double a[3][3], d[3];
+        for (int r = 0; r < 3; r++)
+        {
+            a[r][0] = x[nodes[r + 1]] - x[nodes[0]];
+            a[r][1] = y[nodes[r + 1]] - y[nodes[0]];
+            a[r][2] = z[nodes[r + 1]] - z[nodes[0]];
+            d[r] = T->get(nodes[r + 1]) - T->get(nodes[0]);
+        }
+
+        double det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+                     a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                     a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+
+        for (int c = 0; c < 3; c++)
+        {
+            // Replace column c by d
+            double m[3][3];
+            for (int r = 0; r < 3; r++)
+                for (int j = 0; j < 3; j++)
+                    m[r][j] = j == c ? d[r] : a[r][j];
+
+            double det_c = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                           m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+
+            flux[3 * e + c] = det == 0 ? 0 : -k * det_c / det;
+        }
+    }
 }
@@ -0,0 +1,497 @@
+/**
+ * @file mef_utilities/mef_program.hpp
+ *
+ * @brief The mef program, shared by the executables of every equation
+ *
+ * run_mef<Physics>() is the whole program: options, reading, local systems,
+ * global system, output. Only the element kernel (see physics_kernels.hpp)
+ * and the .dat header change between equations, so each project's main.cpp
+ * just picks them:
+ *
+ *  - MEF 3D - TRASFERENCIA CALOR: run_mef<HeatKernel>()
+ *  - MEF 3D - SEGUNDA ECUACION: run_mef<SecondEquationKernel>()
+ *  - TAREA 2 ... MONTICULOS MINIMOS: run_mef<HeatKernel>() with the nodes
+ *    in the min heap (NODE_STORAGE=HeapNodeStorage) and the skyline solver
+ *
+ * Everything else is this core, see mef_core.hpp.
+ */
+
+/**
+ * @brief Assembly, boundary conditions and solution with the dense K
+ *
+ * @param T_full Output, value of node with ID i at position i - 1
+ */
+void solve_dense(Mesh *M, Matrix *local_Ks, Vector *local_bs, int solver_method, bool run_report, RunReport *report,
+                 Vector *T_full, SolverRecord *solver)
+{
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    Matrix K(num_nodes, num_nodes);
+    Vector b(num_nodes);
+
+    report->phase("assembly");
+    log_message(LOG_SUMMARY, "Performing Assembly...\n");
+    /**
+     * @brief Assembly all local_ks and local_bs into a GLOBAL K and GLOBAL B
+     *
+     * - Local Matrices represent a element with 4 nodes
+     * - Global Matrices represent the solution of the entire mesh
+     *
+     * - Each element has 4 nodes, but this nodes are shared between several elements, so, its necesary
+     * assembly this elements, in order to relate the calculated values into a single node value in the
+     * global matrices
+     */
+    assembly(&K, &b, local_Ks, local_bs, num_elements, M);
+
+    /**
+     * @brief Apply boundary condition
+     *
+     * In MEF there are two types of conditions:
+     * which are predefined values that serve as a starting point in the
+     * calculation of the elements and define the behavior at the boundaries
+     * of the domain.
+     */
+    report->phase("neumann");
+    log_message(LOG_SUMMARY, "Applying Neumann Boundary Conditions...\n");
+    apply_neumann_boundary_conditions(&b, M);
+
+    report->phase("dirichlet");
+    log_message(LOG_SUMMARY, "Applying Dirichlet Boundary Conditions...\n");
+
+    /**
+     * @brief Apply Dirichlet
+     *
+     * The dirichlet conditions are values already determined for some nodes,
+     * so we replace that unknown, and eliminate its corresponding row, and
+     * the column in the same position, because, when replacing the variable,
+     * we must multiply by each column value, to reduce the matrix.
+     **/
+    apply_dirichlet_boundary_conditions(&K, &b, M);
+
+    report->phase("solve");
+    log_message(LOG_SUMMARY, "Solving global system...\n");
+    /**
+     * @brief Solve system
+     *
+     * Last form of global system were
+     *
+     * K*T = B
+     *
+     * So we must clear the matrix of unknowns T, arriving at the form:
+     *
+     * T = (K^-1)(B)
+     *
+     * It is necessary to calculate the inverse matrix of K
+     * and to multiply by the vector B, or to factorize K (--solver cholesky)
+     **/
+    Vector T(b.get_size());
+    if (solver_method == SOLVER_CHOLESKY)
+        solve_system_cholesky(&K, &b, &T);
+    else
+        solve_system(&K, &b, &T);
+    report->end_phase();
+
+    // Direct solver, its residual is checked outside the timed phases
+    solver->unknowns = b.get_size();
+    if (run_report)
+    {
+        solver->nonzeros = assembled_nonzeros(M);
+        solver->residual = relative_residual(&K, &b, &T);
+    }
+
+    /**
+     * @brief Reconstruct result
+     */
+    report->phase("merge");
+    log_message(LOG_SUMMARY, "Preparing results...\n");
+    merge_results_with_dirichlet(&T, T_full, num_nodes, M);
+}
+
+/**
+ * @brief Assembly, boundary conditions and solution with K stored by its
+ * profile, after renumbering the nodes
+ *
+ * @param T_full Output, value of node with ID i at position i - 1
+ */
+void solve_profile(Mesh *M, Matrix *local_Ks, Vector *local_bs, bool run_report, RunReport *report,
+                   Vector *T_full, SolverRecord *solver)
+{
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int *permutation = (int *)malloc(sizeof(int) * num_nodes);
+
+    /**
+     * @brief Node renumbering
+     *
+     * K is stored by its profile, whose size depends on how far apart the
+     * numbers of neighbour nodes are. The Sloan ordering, driven by the
+     * indexed min heap, renumbers the nodes to make that profile small.
+     *
+     * see sloan.hpp -> sloan_ordering() for more details
+     */
+    report->phase("ordering");
+    log_message(LOG_SUMMARY, "Renumbering nodes (Sloan)...\n");
+    sloan_ordering(M, permutation);
+
+    SkylineMatrix K;
+    Vector b(num_nodes);
+
+    report->phase("assembly");
+    log_message(LOG_SUMMARY, "Performing Assembly...\n");
+    assembly(&K, &b, local_Ks, local_bs, num_elements, M, permutation);
+
+    report->phase("neumann");
+    log_message(LOG_SUMMARY, "Applying Neumann Boundary Conditions...\n");
+    apply_neumann_boundary_conditions(&b, M, permutation);
+
+    /**
+     * @brief Apply Dirichlet
+     *
+     * Its column moves to the right hand side and its row and column become
+     * the identity, since a profile matrix can not remove them.
+     **/
+    report->phase("dirichlet");
+    log_message(LOG_SUMMARY, "Applying Dirichlet Boundary Conditions...\n");
+    apply_dirichlet_boundary_conditions(&K, &b, M, permutation);
+
+    /**
+     * @brief Solve system
+     *
+     * K is factorized in place as K = L*(L^T) (Cholesky) and T is found
+     * with a forward and a backward substitution, then it is returned
+     * to the original node numbering. Dirichlet nodes are already part of T
+     * with their condition value.
+     **/
+    report->phase("solve");
+    log_message(LOG_SUMMARY, "Solving global system...\n");
+    long long stored = K.get_stored_values();
+    solve_system(&K, &b, T_full, permutation);
+    report->end_phase();
+    free(permutation);
+
+    // K is factorized in place, so there is no residual to check
+    solver->unknowns = num_nodes;
+    if (run_report)
+        solver->nonzeros = assembled_nonzeros(M);
+    log_message(LOG_DEBUG, "\tProfile of K: " + to_string(stored) + " stored values");
+}
+
+/*
+ * @brief MEF 3D
+ *
+ * Implementation for the Finite Element Method for a 3D mesh using data
+ * from GID Mesh problemType generation
+ *
+ * @param argc number of params passed at execution
+ * @param argv pointer to char chain witch represents every value passed at execution
+ * @param default_solver Solver when --solver is not given
+ *
+ */
+template <class Physics>
+int run_mef(int argc, char **argv, int default_solver = SOLVER_CHOLESKY_INVERSE)
+{
+
+    try
+    {
+
+        /*
+         * @example Correct usage mef.exe input_file [no file extension]
+         * @example mef.exe "Proyectos GID/MALLA_PEQ.gid" [GiD project folder, see gid/gid_project.hpp]
+         * @example mef.exe input_file --binary [results in GiD binary format, see gid/post_binary.hpp]
+         * @example mef.exe input_file --vtu [also mesh and results for ParaView, see gid/vtu_output.hpp]
+         *
+         * --vtu-base64 and --vtu-zlib write the .vtu in base64 or compressed,
+         * --quiet and --debug change the console output, see mef_utilities/logger.hpp
+         * --report writes filename.report.json, see mef_utilities/run_report.hpp
+         * --counters also adds hardware counters to it, see mef_utilities/perf_counters.hpp
+         * --check reference.post.res compares the result with a reference and exits with EXIT_FAILURE if the
+         *   relative L2 error is above --check-tolerance (1e-3), see gid/post_res_compare.hpp
+         * --solver cholesky solves with an in place Cholesky factorization instead of the inverse,
+         *   --solver skyline stores K by its profile after the Sloan ordering, see mef_utilities/sloan.hpp
+         * --dry-run only prints the predicted memory and time, see mef_utilities/memory_budget.hpp
+         * --memory-limit 4G picks the fastest solver that fits, or stops before the local systems
+         * --transient dt steps integrates in time from --initial T0 (0) with --theta (1, backward_euler,
+         *   crank_nicolson or 0 to 1), --mass consistent | lumped and --capacity rho*c (1), writing every
+         *   step to filename.post.res (--check compares the last one), see mef_utilities/transient.hpp
+         *   --explicit euler | rk2 integrates with the lumped C and no solve, dt auto is the stable
+         *   step, see mef_utilities/explicit_transient.hpp. --output-every n only writes every n steps
+         * --conductivity-table file or --conductivity-poly c0,c1,... solves with k(T), by --nonlinear newton
+         *   or picard, until --tolerance (1e-6) or --max-iterations (50), see mef_utilities/nonlinear.hpp
+         */
+        bool binary_output = false, vtu_output = false, vtu_compress = false, run_report = false;
+        vtu_encoding vtu_format = VTU_RAW;
+        string check_reference;
+        double check_tolerance = POST_RES_TOLERANCE;
+        bool dry_run = false;
+        long long memory_limit = 0;
+        int solver_method = default_solver;
+        bool solver_given = false;
+        bool transient = false;
+        TransientSettings settings = {0, 0, 1, MASS_CONSISTENT, 1, 0, EXPLICIT_NONE, 1};
+        Conductivity conductivity;
+        NonlinearSettings nonlinear = {NONLINEAR_NONE, 1e-6, 50};
+        bool conductivity_valid = true;
+        bool valid_options = argc >= 2;
+        for (int a = 2; a < argc; a++)
+        {
+            string option(argv[a]);
+            if (option == "--binary")
+                binary_output = true;
+            else if (option == "--vtu")
+                vtu_output = true;
+            else if (option == "--vtu-base64")
+                vtu_output = true, vtu_format = VTU_BASE64;
+            else if (option == "--vtu-zlib")
+                vtu_output = true, vtu_compress = true;
+            else if (option == "--report")
+                run_report = true;
+            else if (option == "--counters")
+                run_report = true, perf_counters.open();
+            else if (option == "--check" && a + 1 < argc)
+                check_reference = argv[++a];
+            else if (option == "--check-tolerance" && a + 1 < argc)
+                check_tolerance = atof(argv[++a]);
+            else if (option == "--solver" && a + 1 < argc)
+                solver_method = parse_solver(argv[++a]), solver_given = true;
+            else if (option == "--dry-run")
+                dry_run = true;
+            else if (option == "--memory-limit" && a + 1 < argc)
+                memory_limit = parse_memory_size(argv[++a]);
+            else if (option == "--transient" && a + 2 < argc)
+            {
+                transient = true;
+                double time_step = atof(argv[a + 1]);
+                settings.time_step = string(argv[a + 1]) == "auto" ? 0 : time_step > 0 ? time_step : -1;
+                settings.steps = atoi(argv[a + 2]);
+                a += 2;
+            }
+            else if (option == "--theta" && a + 1 < argc)
+                settings.theta = parse_theta(argv[++a]);
+            else if (option == "--mass" && a + 1 < argc)
+                settings.mass = parse_mass(argv[++a]);
+            else if (option == "--capacity" && a + 1 < argc)
+                settings.capacity = atof(argv[++a]);
+            else if (option == "--initial" && a + 1 < argc)
+                settings.initial = atof(argv[++a]);
+            else if (option == "--explicit" && a + 1 < argc)
+                settings.scheme = parse_explicit(argv[++a]);
+            else if (option == "--output-every" && a + 1 < argc)
+                settings.output_every = atoi(argv[++a]);
+            else if (option == "--conductivity-table" && a + 1 < argc)
+                conductivity.read_table(argv[++a]);
+            else if (option == "--conductivity-poly" && a + 1 < argc)
+                conductivity_valid = conductivity.parse_polynomial(argv[++a]);
+            else if (option == "--nonlinear" && a + 1 < argc)
+                nonlinear.method = parse_nonlinear(argv[++a]);
+            else if (option == "--tolerance" && a + 1 < argc)
+                nonlinear.tolerance = atof(argv[++a]);
+            else if (option == "--max-iterations" && a + 1 < argc)
+                nonlinear.max_iterations = atoi(argv[++a]);
+            else if (option == "--quiet")
+                set_log_level(LOG_QUIET);
+            else if (option == "--debug")
+                set_log_level(LOG_DEBUG);
+            else
+                valid_options = false;
+        }
+        if (solver_method < 0 || memory_limit < 0 || check_tolerance <= 0)
+            valid_options = false;
+        // The transient keeps the factorization of the profile path and streams
+        // its steps in ASCII
+        if (settings.theta < 0 || settings.mass < 0 || settings.capacity <= 0 || settings.scheme < 0 ||
+            settings.output_every < 1)
+            valid_options = false;
+        // dt auto (0) is only estimated for the explicit schemes
+        if (transient && (settings.time_step < 0 || (settings.time_step == 0 && settings.scheme == EXPLICIT_NONE) ||
+                          settings.steps < 1 || binary_output ||
+                          (solver_given && solver_method != SOLVER_SKYLINE)))
+            valid_options = false;
+        // k(T) refactorizes the profile of K, and is steady only
+        if (conductivity.is_defined() && nonlinear.method == NONLINEAR_NONE)
+            nonlinear.method = NONLINEAR_NEWTON;
+        if (!conductivity_valid || nonlinear.method < 0 || nonlinear.tolerance <= 0 || nonlinear.max_iterations < 1 ||
+            (nonlinear.method != NONLINEAR_NONE && (!conductivity.is_defined() || transient ||
+                                                    (solver_given && solver_method != SOLVER_SKYLINE))))
+            valid_options = false;
+        if (transient || nonlinear.method != NONLINEAR_NONE)
+            solver_method = SOLVER_SKYLINE;
+        if (!valid_options)
+        {
+            cout << "Incorrect use of the program, it must be: mef filename [--binary] [--vtu | --vtu-base64 | --vtu-zlib] [--quiet | --debug] [--report | --counters] [--check reference.post.res [--check-tolerance value]] [--solver cholesky | cholesky_inverse | skyline] [--dry-run] [--memory-limit size[K|M|G]] [--transient dt steps [--theta value] [--mass consistent | lumped] [--capacity rho_c] [--initial T0] [--explicit euler | rk2] [--output-every n]] [--conductivity-table file | --conductivity-poly c0,c1,... [--nonlinear newton | picard] [--tolerance value] [--max-iterations n]]\n";
+            exit(EXIT_FAILURE);
+        }
+
+        /*
+        Mesh representation declarations
+        */
+        Mesh M;
+        RunReport report;
+
+        report.phase("read");
+        log_message(LOG_SUMMARY, "Reading geometry and mesh data...\n");
+
+        /*
+         Using string constructor from char* to string
+        */
+        string filename(argv[1]);
+
+        /*
+            Read of .dat file saving data in Mesh M, or of the project files
+            when a GiD project folder is given. Results are then written
+            inside the project, as GiD expects
+        */
+        if (is_gid_project(filename))
+        {
+            filename = gid_project_basename(filename);
+            read_gid_project(filename, &M);
+        }
+        else
+            read_input(filename, &M, Physics::problem_values);
+
+        /*
+            Memory budget of every solver, from the sizes of the mesh and the
+            profile of K. With a limit the fastest solver that fits is used,
+            unless a solver was given or the run needs the profile
+        */
+        if (dry_run || memory_limit > 0)
+        {
+            report.phase("memory_budget");
+            int quantities[4];
+            for (int q = NUM_NODES; q <= NUM_NEUMANN; q++)
+                quantities[q] = M.get_quantity((quantity)q);
+
+            MachineRates rates = calibrate_rates();
+            ProfileEstimate profile = estimate_profile(&M);
+            RunEstimate estimates[NUM_SOLVERS];
+            int fastest = choose_solver(quantities, memory_limit, &rates, &profile, estimates);
+            if (dry_run)
+            {
+                report_estimates(quantities, &profile, estimates, fastest, memory_limit);
+                return 0;
+            }
+
+            bool fixed_solver = solver_given || transient || nonlinear.method != NONLINEAR_NONE;
+            if (fixed_solver)
+                fastest = estimates[solver_method].peak_bytes <= memory_limit ? solver_method : -1;
+            if (fastest < 0)
+            {
+                int smallest = solver_method;
+                for (int s = 0; s < NUM_SOLVERS && !fixed_solver; s++)
+                    if (estimates[s].peak_bytes < estimates[smallest].peak_bytes)
+                        smallest = s;
+                throw runtime_error(string("Not enough memory: ") + solver_names[smallest] + " needs " +
+                                    to_string(estimates[smallest].peak_bytes / (1024 * 1024)) + " MB, the limit is " +
+                                    to_string(memory_limit / (1024 * 1024)) + " MB");
+            }
+            solver_method = fastest;
+            log_message(LOG_SUMMARY, string("Solver: ") + solver_names[solver_method] + ", about " +
+                                         to_string(estimates[solver_method].peak_bytes / (1024 * 1024)) + " MB\n");
+        }
+
+        report.phase("report");
+        M.report();
+
+        /**
+         *  @name Global / Acumulative values for FEM calculations
+         */
+        ///@{
+        int num_nodes = M.get_quantity(NUM_NODES); //
+
+        int num_elements = M.get_quantity(NUM_ELEMENTS);
+
+        // On the heap, a million local systems are far more than the stack holds
+        vector<Matrix> local_K_storage(num_elements);
+        vector<Vector> local_b_storage(num_elements);
+        Matrix *local_Ks = local_K_storage.data();
+
+        Vector *local_bs = local_b_storage.data(), T_full(num_nodes);
+        ///@}
+
+        /**
+         * Finite element method
+         * after solving result in a
+         * Linear equation system with the form
+         *
+         * K*X = B
+         *
+         * [a... b][x1]=[e]
+         * [.... .][x2]=[f]
+         * [c... d][x3]=[g]
+         *
+         * Where K is N*N Matrix continaing the coefficients of the unknowns of the system
+         * Where X is N*1 VECTOR continaing the unknowns of the system
+         *
+         * Where B is N*1 VECTOR containing the result of each equation
+         *
+         * This section calculates this Equation System for each element in the mesh
+         * its called a local system. each local system is saved into local_Bs and local_Ks vectors
+         *
+         * Then colects all local systems into a global system,
+         * it´s an assembly process
+         *
+         * see mef_process.hpp -> create_local_systems() for more details
+         */
+
+        report.phase("local_systems");
+        log_message(LOG_SUMMARY, "Creating local systems...\n");
+        create_local_systems<Physics>(local_Ks, local_bs, num_elements, &M);
+
+        SolverRecord solver = {solver_names[solver_method], 0, 0, 0, -1};
+        if (transient && settings.scheme != EXPLICIT_NONE)
+            solve_explicit(&M, local_Ks, local_bs, &settings, filename, &report, &T_full, &solver);
+        else if (transient)
+            solve_transient(&M, local_Ks, local_bs, &settings, filename, &report, &T_full, &solver);
+        else if (nonlinear.method != NONLINEAR_NONE)
+            solve_nonlinear(&M, local_Ks, local_bs, &conductivity, &nonlinear, &report, &T_full, &solver);
+        else if (solver_method == SOLVER_SKYLINE)
+            solve_profile(&M, local_Ks, local_bs, run_report, &report, &T_full, &solver);
+        else
+            solve_dense(&M, local_Ks, local_bs, solver_method, run_report, &report, &T_full, &solver);
+        report_results(&T_full);
+
+        //WRITE [filename].post.res file, or [filename].post.bin. The transient
+        //already wrote every step
+        if (!transient)
+        {
+            report.phase("write");
+            log_message(LOG_SUMMARY, "Writing output file...\n");
+            if (binary_output)
+                write_output_binary(filename, &T_full, &M);
+            else
+                write_output(filename, &T_full, &M);
+        }
+
+        if (vtu_output)
+        {
+            report.phase("write_vtu");
+            // Temperature on the nodes and heat flux on the elements
+            float *flux = (float *)malloc(sizeof(float) * 3 * num_elements);
+            if (Physics::has_flux)
+                calculate_heat_flux(&T_full, &M, flux);
+
+            VtuField fields[2] = {{"Temperature", 1, true, T_full.get_data()},
+                                  {"HeatFlux", 3, false, flux}};
+            write_vtu(filename, &M, fields, Physics::has_flux ? 2 : 1, vtu_format, vtu_compress);
+            free(flux);
+        }
+
+        if (run_report)
+            report.write(filename + ".report.json", argv[1], &M, &solver);
+
+        if (!check_reference.empty())
+        {
+            log_message(LOG_SUMMARY, "Comparing with " + check_reference + "...\n");
+            ResultComparison comparison = compare_post_res(&T_full, &M, check_reference);
+            report_comparison(&comparison);
+            if (!results_within(&comparison, check_tolerance))
+                throw runtime_error("The result differs from " + check_reference + " by more than the tolerance");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+/**
+ * @file mef_utilities/memory_budget.hpp
+ *
+ * @brief Memory and time of a run predicted from the mesh sizes
+ *
+ * The dense K dominates everything: n x n floats from the assembly on,
+ * a second copy of it while every Dirichlet row and column is removed
+ * (Matrix::remove_column() copies the whole matrix), and for the solve
+ *
+ *  - SOLVER_CHOLESKY_INVERSE, solve_system(): K, its inverse and the L
+ *    and Y of calculate_inverse(), four m x m matrices (m unknowns)
+ *  - SOLVER_CHOLESKY, solve_system_cholesky(): only K, factorized in place
+ *
+ *  - SOLVER_SKYLINE, solve_profile(): only the profile of K, factorized
+ *    in place, Dirichlet rows and columns are cleared without copies
+ *
+ * The profile depends on the connectivity and on the node ordering, so it is
+ * measured by estimate_profile() on the mesh with the Sloan ordering of the
+ * actual run, without assembling anything. Transient and k(T) runs use the
+ * same profile, their estimate is the one of a single steady solve.
+ *
+ * The mesh, the local systems and the node storage add a few hundred bytes
+ * per element, and the process itself BUDGET_PROCESS_BYTES. Sizes include
+ * the malloc() overhead of the many small blocks of Matrix.
+ *
+ * Times are estimated for the phases on K only (initialization, Dirichlet
+ * removal, solve), with rates measured on this machine by calibrate_rates()
+ * with matrices of at most BUDGET_CALIBRATION_SIZE rows, and for the
+ * profile a band of BUDGET_CALIBRATION_BAND columns. They are optimistic
+ * for matrices much larger than the caches.
+ */
+#include <chrono>
+
+#define BUDGET_CALIBRATION_SIZE 256
+#define BUDGET_CALIBRATION_BAND 64
+#define BUDGET_PROCESS_BYTES (6 << 20) // program, libraries and stdio buffers
+
+/**
+ * @brief Nanoseconds per operation measured on this machine
+ */
+struct MachineRates
+{
+    double copy_ns;     // per float moved by Matrix::remove_column()
+    double inverse_ns;  // per flop of calculate_inverse()
+    double cholesky_ns; // per flop of solve_system_cholesky()
+    double skyline_ns;  // per flop of SkylineMatrix::factorize()
+};
+
+/**
+ * @brief Profile of K with the Sloan ordering, as SkylineMatrix would store it
+ */
+struct ProfileEstimate
+{
+    long long stored_values;
+    double factorization_flops;
+};
+
+struct RunEstimate
+{
+    solver_method solver;
+    long long mesh_bytes;   // mesh, node storage and adjacency graphs
+    long long local_bytes;  // local K and b of every element
+    long long peak_bytes;   // largest total of any phase
+    double dirichlet_seconds;
+    double solve_seconds;
+    double total_seconds;
+};
+
+/**
+ * @brief Bytes malloc() takes for a block of size bytes: 8 bytes of header,
+ * 16 bytes alignment and 32 bytes at least (glibc, MinGW is similar)
+ */
+long long heap_block_bytes(long long size)
+{
+    long long block = (size + 8 + 15) / 16 * 16;
+    return block < 32 ? 32 : block;
+}
+
+/**
+ * @brief Bytes of a Matrix of rows x cols, one block per row
+ */
+long long matrix_bytes(long long rows, long long cols)
+{
+    return (long long)sizeof(Matrix) + heap_block_bytes(8 * rows) + rows * heap_block_bytes(4 * cols);
+}
+
+/**
+ * @brief Orders the nodes of M as solve_profile() does and measures the
+ * profile that allocate_profile() would allocate
+ */
+ProfileEstimate estimate_profile(Mesh *M)
+{
+    MeshGraph *G = M->get_graph();
+    int n = G->get_num_nodes();
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+    int *permutation = (int *)malloc(sizeof(int) * n);
+    sloan_ordering(M, permutation);
+
+    ProfileEstimate profile = {0, 0};
+    for (int i = 0; i < n; i++)
+    {
+        int row = permutation[i], first = row;
+        for (int p = offset[i]; p < offset[i + 1]; p++)
+            if (permutation[index[p]] < first)
+                first = permutation[index[p]];
+        profile.stored_values += row - first + 1;
+        profile.factorization_flops += (double)(row - first) * (row - first);
+    }
+
+    free(permutation);
+    return profile;
+}
+
+/**
+ * @brief Predicted memory and time of a run
+ *
+ * @param quantities Sizes of the mesh, as in Mesh::get_quantity()
+ * @param profile Profile of K, only read for SOLVER_SKYLINE
+ */
+RunEstimate estimate_run(int *quantities, solver_method solver, MachineRates *rates, ProfileEstimate *profile)
+{
+    long long n = quantities[NUM_NODES], e = quantities[NUM_ELEMENTS];
+    long long d = quantities[NUM_DIRICHLET], c = quantities[NUM_DIRICHLET] + quantities[NUM_NEUMANN];
+    long long m = n - d;
+
+    RunEstimate estimate;
+    estimate.solver = solver;
+
+    // Structure of arrays, objects, pointer lists, node IDs and node storage
+    estimate.mesh_bytes = n * (12 + sizeof(Node) + 8) + e * (20 + sizeof(Element) + sizeof(Element *)) +
+                          c * (4 + sizeof(Condition) + sizeof(Condition *)) + NodeStore<NODE_STORAGE>::bytes_for((int)n);
+    // Adjacency graphs, built for the mesh cache: rows of 4 elements per
+    // element and about 2 (n + e) neighbours
+    estimate.mesh_bytes += 4 * (2 * n + 4 * e + 2 * (n + e));
+
+    estimate.local_bytes = e * (matrix_bytes(4, 4) + sizeof(Vector) + heap_block_bytes(16));
+
+    long long fixed = estimate.mesh_bytes + estimate.local_bytes;
+
+    if (solver == SOLVER_SKYLINE)
+    {
+        // Sloan work arrays and the heap, then K, its row starts, b, the
+        // permutation, the double work vector of the solve and T_full
+        long long ordering = 8 * 4 * n;
+        long long stored = profile->stored_values;
+        long long system = 4 * stored + 4 * n + 8 * (n + 1) + 4 * n + 4 * n + 8 * n + 4 * n;
+        estimate.peak_bytes = BUDGET_PROCESS_BYTES + fixed + (ordering > system ? ordering : system);
+        estimate.dirichlet_seconds = 0;
+        estimate.solve_seconds = profile->factorization_flops * rates->skyline_ns * 1e-9;
+        estimate.total_seconds = (double)stored * rates->copy_ns * 1e-9 + estimate.solve_seconds;
+        return estimate;
+    }
+
+    long long assembly = matrix_bytes(n, n) + 2 * 4 * n;
+    long long dirichlet = d > 0 ? matrix_bytes(n - 1, n) + matrix_bytes(n - 1, n - 1) + 2 * 4 * n : assembly;
+    long long solve = solver == SOLVER_CHOLESKY ? matrix_bytes(m, m) + 4 * m + 8 * m
+                                                : 4 * matrix_bytes(m, m);
+    solve += 4 * (m + n) + 4 * n; // b, T, T_full
+
+    long long largest = assembly > dirichlet ? assembly : dirichlet;
+    largest = largest > solve ? largest : solve;
+    estimate.peak_bytes = BUDGET_PROCESS_BYTES + fixed + largest;
+
+    // Removal k copies the (n - k - 1) x (n - k - 1) remaining matrix
+    double copied = 0;
+    for (long long k = 0; k < d; k++)
+        copied += (double)(n - k - 1) * (n - k - 1);
+    estimate.dirichlet_seconds = copied * rates->copy_ns * 1e-9;
+
+    double cube = (double)m * m * m;
+    estimate.solve_seconds = solver == SOLVER_CHOLESKY ? cube / 3 * rates->cholesky_ns * 1e-9
+                                                       : 5 * cube / 3 * rates->inverse_ns * 1e-9;
+    estimate.total_seconds = (double)n * n * rates->copy_ns * 1e-9 + estimate.dirichlet_seconds + estimate.solve_seconds;
+    return estimate;
+}
+
+/**
+ * @brief Times the dense kernels on small matrices
+ */
+MachineRates calibrate_rates()
+{
+    MachineRates rates;
+    int n = BUDGET_CALIBRATION_SIZE;
+
+    Matrix A(n, n);
+    for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+            A.set(r == c ? n : 1.0f / (1 + r + c), r, c);
+
+    // Copies are short, the fastest of a few runs skips the first page faults
+    rates.copy_ns = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        Matrix copy(n, n);
+        A.clone(&copy);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        copy.remove_column(0);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double ns = seconds * 1e9 / ((double)n * (n - 1));
+        rates.copy_ns = run == 0 || ns < rates.copy_ns ? ns : rates.copy_ns;
+    }
+
+    Matrix X(n, n);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    calculate_inverse(&A, n, &X);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    rates.inverse_ns = seconds * 1e9 / (5.0 * n * n * n / 3);
+
+    Matrix K(n, n);
+    Vector b(n), T(n);
+    A.clone(&K);
+    b.init();
+    start = chrono::steady_clock::now();
+    solve_system_cholesky(&K, &b, &T);
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    rates.cholesky_ns = seconds * 1e9 / ((double)n * n * n / 3);
+
+    // Band matrix, diagonally dominant so the factorization never stalls
+    int rows = 8 * n, band = BUDGET_CALIBRATION_BAND;
+    int *first = (int *)malloc(sizeof(int) * rows);
+    for (int r = 0; r < rows; r++)
+        first[r] = r > band ? r - band : 0;
+    SkylineMatrix S;
+    S.set_profile(rows, first);
+    for (int r = 0; r < rows; r++)
+        for (int c = first[r]; c <= r; c++)
+            S.set(r == c ? 2.0f * band : 1.0f / (1 + r - c), r, c);
+    free(first);
+    start = chrono::steady_clock::now();
+    S.factorize();
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    rates.skyline_ns = seconds * 1e9 / S.factorization_flops();
+
+    return rates;
+}
+
+/**
+ * @brief Fastest solver whose peak fits in limit_bytes (no limit if 0),
+ * -1 if none fits
+ *
+ * @param estimates Output, one per solver
+ */
+int choose_solver(int *quantities, long long limit_bytes, MachineRates *rates, ProfileEstimate *profile,
+                  RunEstimate *estimates)
+{
+    int best = -1;
+    for (int s = 0; s < NUM_SOLVERS; s++)
+    {
+        estimates[s] = estimate_run(quantities, (solver_method)s, rates, profile);
+        bool fits = limit_bytes <= 0 || estimates[s].peak_bytes <= limit_bytes;
+        if (fits && (best == -1 || estimates[s].total_seconds < estimates[best].total_seconds))
+            best = s;
+    }
+    return best;
+}
+
+/**
+ * @brief Memory size such as 512M, 4G, 2.5G or plain bytes, -1 if invalid
+ */
+long long parse_memory_size(string text)
+{
+    char *end;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0)
+        return -1;
+
+    string unit(end);
+    double factor = unit == "" || unit == "B" ? 1 : unit == "K" ? 1024.0
+                                                : unit == "M"   ? 1024.0 * 1024
+                                                : unit == "G"   ? 1024.0 * 1024 * 1024
+                                                                : -1;
+    return factor < 0 ? -1 : (long long)(value * factor);
+}
+
+/**
+ * @brief Prints the estimates of every solver and of the node storages
+ */
+void report_estimates(int *quantities, ProfileEstimate *profile, RunEstimate *estimates, int chosen,
+                      long long limit_bytes)
+{
+    const double MB = 1024.0 * 1024.0;
+    cout << "Nodes " << quantities[NUM_NODES] << ", elements " << quantities[NUM_ELEMENTS] << ", unknowns "
+         << quantities[NUM_NODES] - quantities[NUM_DIRICHLET] << "\n";
+    cout << "Mesh: " << estimates[0].mesh_bytes / MB << " MB, local systems: " << estimates[0].local_bytes / MB << " MB\n";
+    cout << "Node storage: ArrayNodeStorage " << ArrayNodeStorage::bytes_for(quantities[NUM_NODES]) / MB
+         << " MB, HeapNodeStorage " << HeapNodeStorage::bytes_for(quantities[NUM_NODES]) / MB
+         << " MB, HashNodeStorage " << HashNodeStorage::bytes_for(quantities[NUM_NODES]) / MB << " MB\n";
+    cout << "Profile of K (Sloan): " << profile->stored_values << " stored values\n\n";
+
+    cout << "solver,peak_memory_mb,dirichlet_s,solve_s,total_s" << (limit_bytes > 0 ? ",fits" : "") << "\n";
+    for (int s = 0; s < NUM_SOLVERS; s++)
+    {
+        cout << solver_names[s] << "," << estimates[s].peak_bytes / MB << "," << estimates[s].dirichlet_seconds << ","
+             << estimates[s].solve_seconds << "," << estimates[s].total_seconds;
+        if (limit_bytes > 0)
+            cout << "," << (estimates[s].peak_bytes <= limit_bytes ? "yes" : "no");
+        cout << "\n";
+    }
+
+    if (chosen >= 0)
+        cout << "\nFastest" << (limit_bytes > 0 ? " within " + to_string(limit_bytes / (1024 * 1024)) + " MB" : "")
+             << ": " << solver_names[chosen] << "\n";
+    else
+        cout << "\nNo solver fits in " << limit_bytes / MB << " MB\n";
+}
@@ -0,0 +1,452 @@
+/**
+ * @file mef_utilities/nonlinear.hpp
+ *
+ * @brief Steady heat transfer with temperature dependent conductivity k(T)
+ *
+ * Each element uses k_e = k(T_e), at the mean temperature T_e of its 4
+ * nodes. Its local K is the one of the constant k0 of the input scaled by
+ * k_e / k0, so the local systems are computed once, and the equations
+ *
+ *  R(T) = K(T) T - b = 0
+ *
+ * are solved from the solution with k0, with one of:
+ *
+ *  - picard: K(T_n) T_n+1 = b. Linear convergence, each iteration is an
+ *    assembly and a numeric refactorization of K(T_n). It is applied as
+ *    T_n+1 = T_n - K(T_n)^-1 R(T_n), the same iteration, with R in double so
+ *    the float factorization does not limit the accuracy.
+ *  - newton: J(T_n) dT = -R(T_n), with
+ *
+ *      J_e = (k_e / k0) K_e + (k'(T_e) / (4 k0)) (K_e T_e) [1 1 1 1]
+ *
+ *    which is not symmetric, so it is solved inexactly with GMRES,
+ *    preconditioned by the Cholesky factorization of K(T) and warm started
+ *    from the last correction. The tolerance of GMRES follows the
+ *    residual (Eisenstat-Walker, choice 2), and the factorization is kept
+ *    until GMRES needs more than NEWTON_REFACTOR_ITERATIONS iterations.
+ *    Steps are halved while the residual does not decrease.
+ *
+ * The Sloan ordering and the profile of K (the symbolic part) are computed
+ * once, every iteration only fills and factorizes the same profile.
+ *
+ * Iterations stop when ||R(T)|| / ||b|| <= tolerance, with b the right hand
+ * side after moving the Dirichlet columns (as relative_residual()), or
+ * when the largest change of T is below tolerance times the largest |T|.
+ */
+
+enum nonlinear_method
+{
+    NONLINEAR_NONE, // constant k
+    NONLINEAR_PICARD,
+    NONLINEAR_NEWTON,
+    NUM_NONLINEAR_METHODS
+};
+
+static const char *nonlinear_names[NUM_NONLINEAR_METHODS] = {"none", "picard", "newton"};
+
+#define NEWTON_FORCING_MAX 0.5
+#define NEWTON_FORCING_GAMMA 0.9
+#define NEWTON_REFACTOR_ITERATIONS 20
+#define NEWTON_MAX_BACKTRACKS 8
+#define NEWTON_GMRES_ITERATIONS 300
+
+/**
+ * @brief Options of a nonlinear run (--nonlinear, --tolerance,
+ * --max-iterations)
+ */
+struct NonlinearSettings
+{
+    int method; // nonlinear_method
+    double tolerance;
+    int max_iterations;
+};
+
+/**
+ * @brief Nonlinear method of a name of nonlinear_names, -1 if there is none
+ */
+int parse_nonlinear(string name)
+{
+    for (int m = NONLINEAR_PICARD; m < NUM_NONLINEAR_METHODS; m++)
+        if (name == nonlinear_names[m])
+            return m;
+    return -1;
+}
+
+class NonlinearHeatSystem
+{
+private:
+    Mesh *M;
+    Conductivity *conductivity;
+    int num_nodes, num_elements;
+    int *connectivity;
+    int *permutation;
+    Matrix *Ks;        // local K with k0
+    float k0;
+    double *scale;     // k_e / k0
+    double *slope;     // k'(T_e) / (4 k0)
+    double *KT;        // K_e T_e of the last T, 4 per element
+    double *load;      // b with the Neumann conditions
+    char *fixed;       // 1 for Dirichlet nodes
+    SkylineMatrix K;
+    Vector rhs, solution;
+
+    /**
+     * @brief out = sum of scale_e K_e T_e - load
+     */
+    void product(double *T, double *out)
+    {
+        for (int i = 0; i < num_nodes; i++)
+            out[i] = -load[i];
+        for (int e = 0; e < num_elements; e++)
+        {
+            int *nodes = &connectivity[4 * e];
+            for (int r = 0; r < 4; r++)
+            {
+                double sum = 0;
+                for (int c = 0; c < 4; c++)
+                    sum += Ks[e].get(r, c) * T[nodes[c]];
+                out[nodes[r]] += scale[e] * sum;
+            }
+        }
+    }
+
+public:
+    NonlinearHeatSystem(Mesh *mesh, Matrix *local_Ks, Vector *local_bs, Conductivity *k, int *node_permutation)
+        : rhs(mesh->get_quantity(NUM_NODES)), solution(mesh->get_quantity(NUM_NODES))
+    {
+        M = mesh;
+        conductivity = k;
+        Ks = local_Ks;
+        permutation = node_permutation;
+        num_nodes = M->get_quantity(NUM_NODES);
+        num_elements = M->get_quantity(NUM_ELEMENTS);
+        connectivity = M->get_connectivity();
+
+        k0 = M->get_problem_data(THERMAL_CONDUCTIVITY);
+        if (k0 == 0)
+            throw runtime_error("k(T) scales the local systems of the conductivity of the input, which is 0");
+
+        scale = (double *)malloc(sizeof(double) * num_elements);
+        slope = (double *)malloc(sizeof(double) * num_elements);
+        KT = (double *)malloc(sizeof(double) * 4 * num_elements);
+        load = (double *)calloc(num_nodes, sizeof(double));
+        fixed = (char *)calloc(num_nodes, sizeof(char));
+
+        for (int e = 0; e < num_elements; e++)
+        {
+            scale[e] = 1;
+            slope[e] = 0;
+            for (int r = 0; r < 4; r++)
+                load[connectivity[4 * e + r]] += local_bs[e].get(r);
+        }
+        for (int c = 0; c < M->get_quantity(NUM_NEUMANN); c++)
+        {
+            Condition *cond = M->get_neumann_condition(c);
+            load[cond->get_node()->get_ID() - 1] += cond->get_value();
+        }
+        for (int c = 0; c < M->get_quantity(NUM_DIRICHLET); c++)
+            fixed[M->get_dirichlet_condition(c)->get_node()->get_ID() - 1] = 1;
+
+        // Symbolic part, once
+        allocate_profile(&K, M, permutation);
+    }
+
+    ~NonlinearHeatSystem()
+    {
+        free(scale);
+        free(slope);
+        free(KT);
+        free(load);
+        free(fixed);
+    }
+
+    int get_num_nodes()
+    {
+        return num_nodes;
+    }
+
+    long long get_stored_values()
+    {
+        return K.get_stored_values();
+    }
+
+    /**
+     * @brief k_e, k'(T_e) and K_e T_e at the temperature T
+     */
+    void update(double *T)
+    {
+        for (int e = 0; e < num_elements; e++)
+        {
+            int *nodes = &connectivity[4 * e];
+            double mean = (T[nodes[0]] + T[nodes[1]] + T[nodes[2]] + T[nodes[3]]) / 4;
+            scale[e] = conductivity->value(mean) / k0;
+            slope[e] = conductivity->derivative(mean) / (4 * k0);
+            for (int r = 0; r < 4; r++)
+            {
+                double sum = 0;
+                for (int c = 0; c < 4; c++)
+                    sum += Ks[e].get(r, c) * T[nodes[c]];
+                KT[4 * e + r] = sum;
+            }
+        }
+    }
+
+    /**
+     * @brief R(T) with the conductivities of the last update(), 0 on the
+     * Dirichlet nodes
+     *
+     * @return ||R(T)|| / ||b||, b the right hand side once the Dirichlet
+     * values are moved to it
+     */
+    double residual(double *T, double *R)
+    {
+        double *dirichlet = (double *)malloc(sizeof(double) * num_nodes);
+        double *b = (double *)malloc(sizeof(double) * num_nodes);
+        for (int i = 0; i < num_nodes; i++)
+            dirichlet[i] = fixed[i] ? T[i] : 0;
+
+        // Minus the right hand side on the free nodes
+        product(dirichlet, b);
+        for (int i = 0; i < num_nodes; i++)
+            R[i] = 0;
+        for (int e = 0; e < num_elements; e++)
+            for (int r = 0; r < 4; r++)
+                R[connectivity[4 * e + r]] += scale[e] * KT[4 * e + r];
+
+        double norm_R = 0, norm_b = 0;
+        for (int i = 0; i < num_nodes; i++)
+        {
+            R[i] = fixed[i] ? 0 : R[i] - load[i];
+            norm_R += R[i] * R[i];
+            norm_b += fixed[i] ? 0 : b[i] * b[i];
+        }
+        free(dirichlet);
+        free(b);
+        return norm_b > 0 ? sqrt(norm_R / norm_b) : sqrt(norm_R);
+    }
+
+    /**
+     * @brief Assembles K(T) of the last update() into the same profile,
+     * applies the Dirichlet conditions and factorizes it
+     */
+    void factorize()
+    {
+        K.clear();
+        for (int e = 0; e < num_elements; e++)
+            for (int r = 0; r < 4; r++)
+            {
+                int row = permutation[connectivity[4 * e + r]];
+                for (int c = 0; c < 4; c++)
+                    K.add(scale[e] * Ks[e].get(r, c), row, permutation[connectivity[4 * e + c]]);
+            }
+        for (int i = 0; i < num_nodes; i++)
+            rhs.set(load[i], permutation[i]);
+        apply_dirichlet_boundary_conditions(&K, &rhs, M, permutation);
+
+        PerfRegion region("skyline_factorization", K.factorization_flops());
+        K.factorize();
+    }
+
+    /**
+     * @brief T = K^-1 b with the last factorize()
+     */
+    void solve(double *T)
+    {
+        PerfRegion region("skyline_solve", 4.0 * K.get_stored_values());
+        K.solve(&rhs, &solution);
+        for (int i = 0; i < num_nodes; i++)
+            T[i] = solution.get(permutation[i]);
+    }
+
+    /**
+     * @brief out = J v, identity on the Dirichlet nodes
+     */
+    void apply(double *v, double *out)
+    {
+        for (int i = 0; i < num_nodes; i++)
+            out[i] = 0;
+        for (int e = 0; e < num_elements; e++)
+        {
+            int *nodes = &connectivity[4 * e];
+            double local_v[4], sum_v = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                local_v[c] = fixed[nodes[c]] ? 0 : v[nodes[c]];
+                sum_v += local_v[c];
+            }
+            for (int r = 0; r < 4; r++)
+            {
+                double sum = 0;
+                for (int c = 0; c < 4; c++)
+                    sum += Ks[e].get(r, c) * local_v[c];
+                out[nodes[r]] += scale[e] * sum + slope[e] * KT[4 * e + r] * sum_v;
+            }
+        }
+        for (int i = 0; i < num_nodes; i++)
+            if (fixed[i])
+                out[i] = v[i];
+    }
+
+    /**
+     * @brief Preconditioner of the Newton system, z = K^-1 v with the
+     * last factorize()
+     */
+    struct Preconditioner
+    {
+        NonlinearHeatSystem *system;
+
+        void apply(double *v, double *z)
+        {
+            system->precondition(v, z);
+        }
+    };
+
+    void precondition(double *v, double *z)
+    {
+        for (int i = 0; i < num_nodes; i++)
+            rhs.set(v[i], permutation[i]);
+        K.solve(&rhs, &solution);
+        for (int i = 0; i < num_nodes; i++)
+            z[i] = solution.get(permutation[i]);
+    }
+};
+
+/**
+ * @brief Largest |v_i|
+ */
+double max_norm(double *v, int n)
+{
+    double largest = 0;
+    for (int i = 0; i < n; i++)
+        largest = fabs(v[i]) > largest ? fabs(v[i]) : largest;
+    return largest;
+}
+
+/**
+ * @brief Steady solution with k(T), by Picard or Newton iterations
+ *
+ * @param T_full Output, value of node with ID i at position i - 1
+ */
+void solve_nonlinear(Mesh *M, Matrix *local_Ks, Vector *local_bs, Conductivity *conductivity,
+                     NonlinearSettings *settings, RunReport *report, Vector *T_full, SolverRecord *solver)
+{
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int *permutation = (int *)malloc(sizeof(int) * num_nodes);
+
+    report->phase("ordering");
+    log_message(LOG_SUMMARY, "Renumbering nodes (Sloan)...\n");
+    sloan_ordering(M, permutation);
+    NonlinearHeatSystem system(M, local_Ks, local_bs, conductivity, permutation);
+
+    double *T = (double *)malloc(sizeof(double) * num_nodes);
+    double *R = (double *)malloc(sizeof(double) * num_nodes);
+    double *delta = (double *)calloc(num_nodes, sizeof(double));
+    double *trial = (double *)malloc(sizeof(double) * num_nodes);
+
+    // Start from the solution with the constant k of the input
+    report->phase("linear_start");
+    log_message(LOG_SUMMARY, "Solving with the constant conductivity...\n");
+    system.factorize();
+    system.solve(T);
+
+    report->phase("iterations");
+    log_message(LOG_SUMMARY, string("Iterating with k(T) (") + nonlinear_names[settings->method] + ")...\n");
+    system.update(T);
+    double residual = system.residual(T, R);
+    double previous_residual = residual, forcing = NEWTON_FORCING_MAX;
+    int iterations = 0, gmres_iterations = 0, factorizations = 1;
+    bool converged = residual <= settings->tolerance;
+    bool factorized = false; // K of the current T, for Newton
+
+    while (!converged && iterations < settings->max_iterations)
+    {
+        iterations++;
+        double change;
+
+        if (settings->method == NONLINEAR_PICARD)
+        {
+            system.factorize();
+            factorizations++;
+            for (int i = 0; i < num_nodes; i++)
+                R[i] = -R[i];
+            system.precondition(R, delta);
+            for (int i = 0; i < num_nodes; i++)
+                T[i] += delta[i];
+            change = max_norm(delta, num_nodes);
+            system.update(T);
+            residual = system.residual(T, R);
+        }
+        else
+        {
+            if (!factorized || gmres_iterations > NEWTON_REFACTOR_ITERATIONS)
+            {
+                system.factorize();
+                factorizations++;
+                factorized = true;
+            }
+
+            // Eisenstat-Walker, choice 2, with its safeguard
+            if (iterations > 1)
+            {
+                double next = NEWTON_FORCING_GAMMA * (residual / previous_residual) * (residual / previous_residual);
+                double safeguard = NEWTON_FORCING_GAMMA * forcing * forcing;
+                forcing = safeguard > 0.1 && safeguard > next ? safeguard : next;
+                forcing = forcing < NEWTON_FORCING_MAX ? forcing : NEWTON_FORCING_MAX;
+            }
+
+            for (int i = 0; i < num_nodes; i++)
+                R[i] = -R[i];
+            NonlinearHeatSystem::Preconditioner preconditioner = {&system};
+            double linear_residual;
+            {
+                PerfRegion region("gmres", 0);
+                gmres_iterations = gmres(&system, &preconditioner, num_nodes, R, delta, forcing,
+                                         NEWTON_GMRES_ITERATIONS, &linear_residual);
+            }
+
+            // Halve the step while the residual does not decrease
+            previous_residual = residual;
+            double step = 1;
+            for (int backtrack = 0; backtrack <= NEWTON_MAX_BACKTRACKS; backtrack++)
+            {
+                for (int i = 0; i < num_nodes; i++)
+                    trial[i] = T[i] + step * delta[i];
+                system.update(trial);
+                residual = system.residual(trial, R);
+                if (residual < (1 - 1e-4 * step) * previous_residual || backtrack == NEWTON_MAX_BACKTRACKS)
+                    break;
+                step /= 2;
+            }
+            for (int i = 0; i < num_nodes; i++)
+                T[i] = trial[i];
+            change = step * max_norm(delta, num_nodes);
+            log_message(LOG_DEBUG, "\tGMRES: " + to_string(gmres_iterations) + " iterations, tolerance " +
+                                       to_string(forcing) + ", step " + to_string(step));
+        }
+
+        log_message(LOG_SUMMARY, "\tIteration " + to_string(iterations) + ": residual " + to_string(residual) +
+                                     ", largest change " + to_string(change) + "\n");
+        converged = residual <= settings->tolerance || change <= settings->tolerance * max_norm(T, num_nodes);
+    }
+    report->end_phase();
+
+    if (!converged)
+        log_message(LOG_SUMMARY, "Warning: k(T) did not converge in " + to_string(iterations) + " iterations\n");
+    log_message(LOG_DEBUG, "\tFactorizations: " + to_string(factorizations) + " of " +
+                               to_string(system.get_stored_values()) + " stored values");
+
+    for (int i = 0; i < num_nodes; i++)
+        T_full->set(T[i], i);
+
+    free(T);
+    free(R);
+    free(delta);
+    free(trial);
+    free(permutation);
+
+    solver->method = nonlinear_names[settings->method];
+    solver->unknowns = num_nodes;
+    solver->nonzeros = assembled_nonzeros(M);
+    solver->iterations = iterations;
+    solver->residual = residual;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file mef_utilities/perf_counters.hpp
+ *
+ * @brief Hardware performance counters of the phases and solver kernels
+ *
+ * On Linux, open() starts four counters of the whole process with
+ * perf_event_open(): cycles, instructions, last level cache misses and
+ * branch misses. They are opened with inherit, so the OpenMP threads
+ * created afterwards are counted too, and only user space is counted, which
+ * the default perf_event_paranoid setting allows. The run report reads
+ * them at the start and end of every phase, and PerfRegion does the same
+ * around a kernel.
+ *
+ * Derived values:
+ *
+ *  - IPC = instructions / cycles
+ *  - bytes per flop = LLC misses * PERF_CACHE_LINE_BYTES / flops, the
+ *    memory traffic per operation. Flops are the estimates the kernels
+ *    give to PerfRegion; phases add up the kernels they ran.
+ *
+ * A counter that cannot be opened (no PMU in a virtual machine, not
+ * permitted, another platform, PERF_COUNTERS set to 0) is reported as null
+ * and get_status() says why; the kernels are still timed.
+ * When the kernel multiplexes the counters, values are scaled by the time
+ * each one was enabled over the time it was running.
+ */
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS 1
+#endif
+
+#if PERF_COUNTERS && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define PERF_CACHE_LINE_BYTES 64
+#define PERF_MAX_KERNELS 16
+
+enum perf_counter
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    NUM_PERF_COUNTERS
+};
+
+static const char *perf_counter_names[NUM_PERF_COUNTERS] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+
+/**
+ * @brief Raw values of the counters at one moment
+ */
+struct PerfReading
+{
+    long long value[NUM_PERF_COUNTERS];
+    long long enabled[NUM_PERF_COUNTERS];
+    long long running[NUM_PERF_COUNTERS];
+};
+
+class PerfCounters
+{
+private:
+    int fd[NUM_PERF_COUNTERS];
+    bool requested;
+    string status;
+
+public:
+    PerfCounters()
+    {
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            fd[c] = -1;
+        requested = false;
+        status = "not requested";
+    }
+
+    ~PerfCounters()
+    {
+#if PERF_COUNTERS && defined(__linux__)
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            if (fd[c] != -1)
+                close(fd[c]);
+#endif
+    }
+
+    /**
+     * @brief Opens the counters, call it before the first parallel region
+     * so the OpenMP threads inherit them
+     */
+    void open()
+    {
+        requested = true;
+#if PERF_COUNTERS && defined(__linux__)
+        static const unsigned long long configs[NUM_PERF_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+        int opened = 0;
+        string failure;
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[c];
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fd[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd[c] == -1)
+                failure = string(perf_counter_names[c]) + ": " + strerror(errno);
+            else
+                opened++;
+        }
+        status = opened == NUM_PERF_COUNTERS ? "ok" : opened == 0 ? "unavailable (" + failure + ")" : "partial (" + failure + ")";
+#elif PERF_COUNTERS
+        status = "unavailable (perf_event_open is only on Linux)";
+#else
+        status = "unavailable (built with PERF_COUNTERS=0)";
+#endif
+    }
+
+    /**
+     * @brief True once open() was called, even if no counter could be opened
+     */
+    bool is_requested()
+    {
+        return requested;
+    }
+
+    string get_status()
+    {
+        return status;
+    }
+
+    void read(PerfReading *reading)
+    {
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+        {
+            reading->value[c] = reading->enabled[c] = reading->running[c] = -1;
+#if PERF_COUNTERS && defined(__linux__)
+            unsigned long long data[3];
+            if (fd[c] != -1 && ::read(fd[c], data, sizeof(data)) == (ssize_t)sizeof(data))
+            {
+                reading->value[c] = (long long)data[0];
+                reading->enabled[c] = (long long)data[1];
+                reading->running[c] = (long long)data[2];
+            }
+#endif
+        }
+    }
+
+    /**
+     * @brief Counts between two readings, -1 for counters that are not
+     * available or never ran in between
+     */
+    static void difference(PerfReading *start, PerfReading *end, double *counts)
+    {
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+        {
+            long long running = end->running[c] - start->running[c];
+            if (start->value[c] < 0 || end->value[c] < 0 || running <= 0)
+                counts[c] = -1;
+            else
+                counts[c] = (double)(end->value[c] - start->value[c]) * (end->enabled[c] - start->enabled[c]) / running;
+        }
+    }
+};
+
+PerfCounters perf_counters;
+
+double perf_flops = 0; // flop estimates of every PerfRegion so far
+
+/**
+ * @brief Totals of a kernel over all its calls
+ */
+struct PerfKernelRecord
+{
+    const char *name;
+    long long calls;
+    double ms;
+    double flops;
+    double counts[NUM_PERF_COUNTERS];
+};
+
+PerfKernelRecord perf_kernels[PERF_MAX_KERNELS];
+int perf_num_kernels = 0;
+
+/**
+ * @brief Counts a kernel from construction to destruction
+ *
+ * Does nothing unless the counters were requested. Kernels are called from
+ * the main thread, between parallel regions.
+ *
+ * @param flops Estimate of the floating point operations of the call
+ */
+class PerfRegion
+{
+private:
+    PerfKernelRecord *record;
+    double flops;
+    PerfReading start;
+    chrono::steady_clock::time_point start_time;
+
+public:
+    PerfRegion(const char *name, double flop_estimate)
+    {
+        record = NULL;
+        flops = flop_estimate;
+        if (!perf_counters.is_requested())
+            return;
+
+        for (int k = 0; k < perf_num_kernels && record == NULL; k++)
+            if (strcmp(perf_kernels[k].name, name) == 0)
+                record = &perf_kernels[k];
+        if (record == NULL && perf_num_kernels < PERF_MAX_KERNELS)
+        {
+            record = &perf_kernels[perf_num_kernels++];
+            record->name = name;
+            record->calls = 0;
+            record->ms = record->flops = 0;
+            for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+                record->counts[c] = 0;
+        }
+        start_time = chrono::steady_clock::now();
+        perf_counters.read(&start);
+    }
+
+    ~PerfRegion()
+    {
+        if (record == NULL)
+            return;
+
+        PerfReading end;
+        perf_counters.read(&end);
+        double counts[NUM_PERF_COUNTERS];
+        PerfCounters::difference(&start, &end, counts);
+
+        record->calls++;
+        record->ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+        record->flops += flops;
+        for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+            record->counts[c] = counts[c] < 0 || record->counts[c] < 0 ? -1 : record->counts[c] + counts[c];
+        perf_flops += flops;
+    }
+};
+
+/**
+ * @brief Writes the counters and derived values as JSON members, null where
+ * they are not available
+ */
+void write_perf_json(FILE *file, double *counts, double flops)
+{
+    for (int c = 0; c < NUM_PERF_COUNTERS; c++)
+    {
+        if (counts[c] < 0)
+            fprintf(file, "\"%s\": null, ", perf_counter_names[c]);
+        else
+            fprintf(file, "\"%s\": %.0f, ", perf_counter_names[c], counts[c]);
+    }
+
+    if (counts[PERF_CYCLES] > 0 && counts[PERF_INSTRUCTIONS] >= 0)
+        fprintf(file, "\"ipc\": %.4f, ", counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES]);
+    else
+        fprintf(file, "\"ipc\": null, ");
+
+    fprintf(file, "\"flops\": %.0f, ", flops);
+    if (flops > 0 && counts[PERF_LLC_MISSES] >= 0)
+        fprintf(file, "\"bytes_per_flop\": %.6g", counts[PERF_LLC_MISSES] * PERF_CACHE_LINE_BYTES / flops);
+    else
+        fprintf(file, "\"bytes_per_flop\": null");
+}
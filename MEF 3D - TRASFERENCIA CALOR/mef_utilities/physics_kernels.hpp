@@ -0,0 +1,166 @@
+/**
+ * @file mef_utilities/physics_kernels.hpp
+ *
+ * @brief Element kernels of the equations solved with this core
+ *
+ * Both equations share the geometry of the linear tetrahedron: with J the
+ * jacobian, A the attached matrix of calculate_local_A() and B the one of
+ * calculate_B(), their local K is a scalar times
+ *
+ *  G = (B^T)(A^T)(A*B) = (A*B)^T (A*B)
+ *
+ * and their local b a scalar times [1, 1, 1, 1]. A kernel only gives those
+ * two scalars:
+ *
+ *  - HeatKernel: (k*V)/(J*J) and Q*J/24, heat transfer
+ *  - SecondEquationKernel: 1/(3360*J) and J/105, see "APLICACION 2da ECUACION"
+ *
+ * create_local_systems<Physics>() takes the kernel as a template parameter,
+ * so each executable gets the geometry and its scalars inlined into one loop
+ * over the structure of arrays of the mesh, with no 3x3 and 4x4 Matrix
+ * temporaries. The loop computes A*B directly: B only subtracts node 1,
+ * so column 0 of A*B is minus the sum of the columns of A.
+ *
+ * A kernel also says how many problem values the .dat header has before
+ * the boundary values (k and Q for heat, none for the second equation), and
+ * whether -k grad(T) is a meaningful flux for the .vtu output.
+ */
+
+/**
+ * @brief Geometry of one tetrahedron, shared by every kernel
+ */
+struct TetrahedronGeometry
+{
+    float J;       // as calculate_local_jacobian()
+    float volume;  // as calculate_local_volume()
+    float G[4][4]; // (A*B)^T (A*B)
+};
+
+/**
+ * @brief 3x3 determinant with the terms in the order of determinant()
+ */
+inline float determinant3(float a00, float a01, float a02, float a10, float a11, float a12, float a20, float a21, float a22)
+{
+    return a00 * a11 * a22 - a00 * a12 * a21 - a01 * a10 * a22 + a01 * a12 * a20 + a02 * a10 * a21 - a02 * a11 * a20;
+}
+
+/**
+ * @brief Geometry of the element with nodes at compact indices nodes[0..3]
+ */
+inline void tetrahedron_geometry(float *x, float *y, float *z, int *nodes, TetrahedronGeometry *g)
+{
+    float x1 = x[nodes[0]], y1 = y[nodes[0]], z1 = z[nodes[0]],
+          x2 = x[nodes[1]], y2 = y[nodes[1]], z2 = z[nodes[1]],
+          x3 = x[nodes[2]], y3 = y[nodes[2]], z3 = z[nodes[2]],
+          x4 = x[nodes[3]], y4 = y[nodes[3]], z4 = z[nodes[3]];
+
+    g->J = determinant3(x2 - x1, x3 - x1, x4 - x1,
+                        y2 - y1, y3 - y1, y4 - y1,
+                        z2 - z1, z3 - z1, z4 - z1);
+    g->volume = (1.0 / 6.0) * fabs(determinant3(x2 - x1, y2 - y1, z2 - z1,
+                                                x3 - x1, y3 - y1, z3 - z1,
+                                                x4 - x1, y4 - y1, z4 - z1));
+
+    // The same terms as calculate_local_A()
+    float A[3][3] = {
+        {(y3 - y1) * (z4 - z1) - (y4 - y1) * (z3 - z1), -(x3 - x1) * (z4 - z1) + (x4 - x1) * (z3 - z1), (x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1)},
+        {-(y2 - y1) * (z4 - z1) + (y4 - y1) * (z2 - z1), (x2 - x1) * (y4 - y1) + (x4 - x1) * (y2 - y1), -(x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1)},
+        {(y2 - y1) * (z3 - z1) - (y3 - y1) * (z2 - z1), -(x2 - x1) * (z3 - z1) + (x3 - x1) * (z2 - z1), (x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1)}};
+
+    float AB[3][4];
+    for (int r = 0; r < 3; r++)
+    {
+        AB[r][0] = -(A[r][0] + A[r][1] + A[r][2]);
+        AB[r][1] = A[r][0];
+        AB[r][2] = A[r][1];
+        AB[r][3] = A[r][2];
+    }
+
+    for (int i = 0; i < 4; i++)
+        for (int j = i; j < 4; j++)
+            g->G[i][j] = g->G[j][i] = AB[0][i] * AB[0][j] + AB[1][i] * AB[1][j] + AB[2][i] * AB[2][j];
+}
+
+/**
+ * @brief [((k*V)/(J*J))((B^T)(A^T)(A*B))][T1, T2, T3, T4]=(Q*J/24)[1,1,1,1]
+ */
+struct HeatKernel
+{
+    static const int problem_values = 2; // k and Q
+    static const bool has_flux = true;
+
+    float k, Q;
+
+    HeatKernel(Mesh *M)
+    {
+        k = M->get_problem_data(THERMAL_CONDUCTIVITY);
+        Q = M->get_problem_data(HEAT_SOURCE);
+    }
+
+    static const char *name()
+    {
+        return "heat";
+    }
+
+    inline float stiffness_scale(TetrahedronGeometry *g)
+    {
+        // Same dump patch as create_local_K()
+        float J = g->J == 0 || isnan(g->J) ? 0.000006f : g->J;
+        float volume = g->volume == 0 || isnan(g->volume) ? 0.000006f : g->volume;
+        return k * volume / (J * J);
+    }
+
+    inline float load(TetrahedronGeometry *g)
+    {
+        return Q * g->J / 24;
+    }
+};
+
+/**
+ * @brief [((1)/(3360*J))((B^T)(A^T)(A*B))][X1, X2, X3, X4]=(J/105)[1,1,1,1]
+ */
+struct SecondEquationKernel
+{
+    static const int problem_values = 0;
+    static const bool has_flux = false;
+
+    SecondEquationKernel(Mesh *) {}
+
+    static const char *name()
+    {
+        return "second_equation";
+    }
+
+    inline float stiffness_scale(TetrahedronGeometry *g)
+    {
+        float J = g->J == 0 || isnan(g->J) ? 0.000006f : g->J;
+        return 1 / (3360 * J);
+    }
+
+    inline float load(TetrahedronGeometry *g)
+    {
+        return g->J / 105;
+    }
+};
+
+/**
+ * @brief Local K and b of element e with the kernel of Physics
+ */
+template <class Physics>
+inline void create_local_system(Physics *physics, Matrix *K, Vector *b, int e, Mesh *M)
+{
+    TetrahedronGeometry g;
+    tetrahedron_geometry(M->get_x_coordinates(), M->get_y_coordinates(), M->get_z_coordinates(), &M->get_connectivity()[4 * e], &g);
+
+    K->set_size(4, 4);
+    b->set_size(4);
+
+    float scale = physics->stiffness_scale(&g);
+    for (int r = 0; r < 4; r++)
+        for (int c = 0; c < 4; c++)
+            K->set(scale * g.G[r][c], r, c);
+
+    float load = physics->load(&g);
+    for (int r = 0; r < 4; r++)
+        b->set(load, r);
+}
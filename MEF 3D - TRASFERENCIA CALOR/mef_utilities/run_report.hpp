@@ -0,0 +1,309 @@
+/**
+ * @file mef_utilities/run_report.hpp
+ *
+ * @brief Per phase timing and memory of a run, written as JSON
+ *
+ * main() runs its phases one after another, so RunReport::phase() closes
+ * the current phase and opens the next one. For every phase it keeps:
+ *
+ *  - wall time in milliseconds
+ *  - peak resident set size of the process at the end of the phase
+ *  - change of the memory in use (heap on glibc, private bytes on Windows)
+ *  - number and bytes of operator new calls, counted by the replacement
+ *    operators below (most arrays of this project come from malloc() and
+ *    are only seen in the memory in use)
+ *
+ * write() adds the mesh size, the nonzeros of K and the solver data, so the
+ * file can be compared across builds and meshes. Sizes are -1 where the
+ * platform does not report them.
+ *
+ * When perf_counters was opened, every phase and the solver kernels also
+ * get hardware counters, IPC and bytes per flop, see perf_counters.hpp.
+ */
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no -lpsapi
+#endif
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <malloc.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define RUN_REPORT_MAX_PHASES 32
+
+/**
+ * @brief Set COUNT_ALLOCATIONS to 0 to keep the default operator new
+ */
+#ifndef COUNT_ALLOCATIONS
+#define COUNT_ALLOCATIONS 1
+#endif
+
+atomic<long long> new_calls(0);
+atomic<long long> new_bytes(0);
+
+#if COUNT_ALLOCATIONS
+void *operator new(size_t size)
+{
+    new_calls.fetch_add(1, memory_order_relaxed);
+    new_bytes.fetch_add(size, memory_order_relaxed);
+    void *pointer = malloc(size > 0 ? size : 1);
+    if (pointer == NULL)
+        throw bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+#endif
+
+/**
+ * @brief Peak resident set size of the process in bytes
+ */
+long long peak_rss_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return (long long)counters.PeakWorkingSetSize;
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (long long)usage.ru_maxrss * 1024; // kilobytes on Linux
+    return -1;
+#endif
+}
+
+/**
+ * @brief Memory allocated by the process and not yet freed, in bytes
+ */
+long long memory_in_use_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS *)&counters, sizeof(counters)))
+        return (long long)counters.PrivateUsage;
+    return -1;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (long long)(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief Writes a JSON string with its quotes, paths may have backslashes
+ */
+void write_json_string(FILE *file, string text)
+{
+    fputc('"', file);
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        unsigned char c = text[i];
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+struct PhaseRecord
+{
+    string name;
+    double ms;
+    long long peak_rss;
+    long long memory_delta;
+    long long allocations;
+    long long allocated_bytes;
+    double counts[NUM_PERF_COUNTERS]; // -1 if not available
+    double flops;                     // estimates of the kernels of the phase
+};
+
+/**
+ * @brief Solver data of the report, iterations is 0 for direct solvers
+ */
+struct SolverRecord
+{
+    string method;
+    int unknowns;
+    long long nonzeros; // of the assembled K, before the Dirichlet conditions
+    int iterations;
+    double residual; // ||K*T - b|| / ||b||, -1 when K was factorized in place
+};
+
+class RunReport
+{
+private:
+    PhaseRecord phases[RUN_REPORT_MAX_PHASES];
+    int num_phases;
+    bool open;
+
+    chrono::steady_clock::time_point run_start, phase_start;
+    long long start_memory, start_calls, start_bytes;
+    PerfReading start_counters;
+    double start_flops;
+
+    static double elapsed_ms(chrono::steady_clock::time_point since)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+    }
+
+public:
+    RunReport()
+    {
+        num_phases = 0;
+        open = false;
+        run_start = chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Ends the current phase, if any, and starts a new one
+     */
+    void phase(const char *name)
+    {
+        end_phase();
+        if (num_phases == RUN_REPORT_MAX_PHASES)
+            return;
+
+        phases[num_phases].name = name;
+        start_memory = memory_in_use_bytes();
+        start_calls = new_calls.load();
+        start_bytes = new_bytes.load();
+        start_flops = perf_flops;
+        perf_counters.read(&start_counters);
+        phase_start = chrono::steady_clock::now();
+        open = true;
+    }
+
+    void end_phase()
+    {
+        if (!open)
+            return;
+
+        PhaseRecord &record = phases[num_phases++];
+        record.ms = elapsed_ms(phase_start);
+        PerfReading end_counters;
+        perf_counters.read(&end_counters);
+        PerfCounters::difference(&start_counters, &end_counters, record.counts);
+        record.flops = perf_flops - start_flops;
+        record.peak_rss = peak_rss_bytes();
+        long long memory = memory_in_use_bytes();
+        record.memory_delta = memory >= 0 && start_memory >= 0 ? memory - start_memory : -1;
+        record.allocations = new_calls.load() - start_calls;
+        record.allocated_bytes = new_bytes.load() - start_bytes;
+        open = false;
+    }
+
+    /**
+     * @brief Writes the report, closing the last phase
+     */
+    void write(string path, string input, Mesh *M, SolverRecord *solver)
+    {
+        end_phase();
+        double total_ms = elapsed_ms(run_start);
+
+        FILE *file = fopen(path.c_str(), "w");
+        if (file == NULL)
+            throw runtime_error("Could not create " + path);
+
+        fprintf(file, "{\n  \"input\": ");
+        write_json_string(file, input);
+        fprintf(file, ",\n  \"build\": {\"compiler\": ");
+        write_json_string(file, __VERSION__);
+#ifdef _OPENMP
+        fprintf(file, ", \"openmp_threads\": %d},\n", omp_get_max_threads());
+#else
+        fprintf(file, ", \"openmp_threads\": 0},\n");
+#endif
+        fprintf(file, "  \"mesh\": {\"nodes\": %d, \"elements\": %d, \"dirichlet\": %d, \"neumann\": %d},\n",
+                M->get_quantity(NUM_NODES), M->get_quantity(NUM_ELEMENTS),
+                M->get_quantity(NUM_DIRICHLET), M->get_quantity(NUM_NEUMANN));
+        fprintf(file, "  \"solver\": {\"method\": ");
+        write_json_string(file, solver->method);
+        fprintf(file, ", \"unknowns\": %d, \"nnz\": %lld, \"iterations\": %d, \"residual\": ",
+                solver->unknowns, solver->nonzeros, solver->iterations);
+        if (solver->residual < 0)
+            fprintf(file, "null},\n");
+        else
+            fprintf(file, "%.9g},\n", solver->residual);
+
+        fprintf(file, "  \"phases\": [\n");
+        for (int p = 0; p < num_phases; p++)
+        {
+            fprintf(file, "    {\"name\": ");
+            write_json_string(file, phases[p].name);
+            fprintf(file, ", \"ms\": %.3f, \"peak_rss_bytes\": %lld, \"memory_delta_bytes\": %lld, "
+                          "\"allocations\": %lld, \"allocated_bytes\": %lld",
+                    phases[p].ms, phases[p].peak_rss, phases[p].memory_delta,
+                    phases[p].allocations, phases[p].allocated_bytes);
+            if (perf_counters.is_requested())
+            {
+                fprintf(file, ", \"counters\": {");
+                write_perf_json(file, phases[p].counts, phases[p].flops);
+                fprintf(file, "}");
+            }
+            fprintf(file, "}%s\n", p + 1 < num_phases ? "," : "");
+        }
+        fprintf(file, "  ],\n");
+
+        if (perf_counters.is_requested())
+        {
+            fprintf(file, "  \"counters_status\": ");
+            write_json_string(file, perf_counters.get_status());
+            fprintf(file, ",\n  \"kernels\": [\n");
+            for (int k = 0; k < perf_num_kernels; k++)
+            {
+                fprintf(file, "    {\"name\": ");
+                write_json_string(file, perf_kernels[k].name);
+                fprintf(file, ", \"calls\": %lld, \"ms\": %.3f, ", perf_kernels[k].calls, perf_kernels[k].ms);
+                write_perf_json(file, perf_kernels[k].counts, perf_kernels[k].flops);
+                fprintf(file, "}%s\n", k + 1 < perf_num_kernels ? "," : "");
+            }
+            fprintf(file, "  ],\n");
+        }
+        fprintf(file, "  \"total_ms\": %.3f,\n  \"peak_rss_bytes\": %lld\n}\n", total_ms, peak_rss_bytes());
+
+        if (fclose(file) != 0)
+            throw runtime_error("Could not write " + path);
+    }
+};
@@ -0,0 +1,251 @@
+/**
+ * @file mef_utilities/sloan.hpp
+ *
+ * @brief Sloan node ordering for profile reduction
+ *
+ * The profile (skyline) of K depends on the node numbering: for each row i
+ * it stores every column between the first nonzero and the diagonal, so
+ * neighbour nodes with distant numbers make rows long. Sloan's algorithm
+ * (S. W. Sloan, 1986) renumbers the nodes walking the mesh from one end to the
+ * other, always taking next the node with the highest priority
+ *
+ *  P(i) = W1 * dist(i, end) - W2 * (current degree of i + 1)
+ *
+ * where the current degree counts the neighbours that would enter the front
+ * if i were numbered next. The queue of candidates is the IndexedMinHeap of
+ * geometry/heap.hpp, priorities only grow so they are stored as -P and raised
+ * with decrease_key.
+ *
+ * The node graph comes from Mesh::get_graph(), node index = ID - 1.
+ * The result is permutation[old index] = new index.
+ */
+
+// Weights recommended by Kumfert and Pothen for finite element meshes
+#define SLOAN_W1 2
+#define SLOAN_W2 1
+
+enum sloan_status
+{
+    INACTIVE,   // not reached yet
+    PREACTIVE,  // neighbour of an active node, in the queue
+    ACTIVE,     // neighbour of a numbered node, in the queue
+    POSTACTIVE  // already numbered
+};
+
+/**
+ * @brief Breadth first search from root inside the component of root
+ *
+ * @param level Output level of every reached node, must be -1 for unvisited nodes
+ * @param queue Work array of num_nodes values, holds the visited nodes in BFS order
+ * @return number of nodes reached, the last one is in the deepest level
+ */
+int sloan_bfs(MeshGraph *G, int root, int *level, int *queue)
+{
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+
+    int head = 0, tail = 0;
+    queue[tail++] = root;
+    level[root] = 0;
+
+    while (head < tail)
+    {
+        int i = queue[head++];
+        for (int p = offset[i]; p < offset[i + 1]; p++)
+        {
+            int j = index[p];
+            if (level[j] == -1)
+            {
+                level[j] = level[i] + 1;
+                queue[tail++] = j;
+            }
+        }
+    }
+
+    return tail;
+}
+
+/**
+ * @brief Marks the nodes reached by the last sloan_bfs() as unvisited again
+ *
+ * Only the reached nodes are reset, so a mesh with many components does not
+ * pay O(num_nodes) per component.
+ */
+void clear_bfs_levels(int *level, int *queue, int reached)
+{
+    for (int q = 0; q < reached; q++)
+        level[queue[q]] = -1;
+}
+
+/**
+ * @brief Finds a start and an end node that are (almost) as far apart as
+ * possible inside the component of seed
+ *
+ * Starting from the seed, a BFS gives the level structure, the lowest degree
+ * node of the last level becomes the new root while the depth keeps growing.
+ *
+ * @param level Work array, -1 for every node on entry and again on return
+ */
+void sloan_pseudo_peripheral_nodes(MeshGraph *G, int seed, int *start, int *end, int *level, int *queue)
+{
+    int root = seed, depth = -1;
+    int candidate = seed;
+
+    while (true)
+    {
+        int reached = sloan_bfs(G, root, level, queue);
+        int root_depth = level[queue[reached - 1]];
+        bool deeper = root_depth > depth;
+
+        if (deeper)
+        {
+            depth = root_depth;
+            *start = root;
+
+            // lowest degree node in the deepest level
+            candidate = queue[reached - 1];
+            for (int q = reached - 1; q >= 0 && level[queue[q]] == depth; q--)
+                if (G->count_neighbours_of(queue[q]) < G->count_neighbours_of(candidate))
+                    candidate = queue[q];
+
+            *end = candidate;
+            root = candidate;
+        }
+
+        clear_bfs_levels(level, queue, reached);
+        if (!deeper)
+            break;
+    }
+}
+
+/**
+ * @brief Raises the priority of node j by W2, queueing it if it was inactive
+ */
+void raise_sloan_priority(MeshGraph *G, IndexedMinHeap *candidates, int *status, int *distance, int j)
+{
+    if (status[j] == INACTIVE)
+    {
+        status[j] = PREACTIVE;
+        candidates->insert(j, -(SLOAN_W1 * distance[j] - SLOAN_W2 * (G->count_neighbours_of(j) + 1)));
+    }
+
+    if (candidates->contains(j))
+        candidates->decrease_key(j, candidates->get_key(j) - SLOAN_W2);
+}
+
+/**
+ * @brief Computes the Sloan ordering of every node of the mesh
+ *
+ * Each connected component is numbered in turn. The work arrays are reset
+ * only on the nodes of the component, so the cost stays linear in the size
+ * of the graph however many components there are.
+ *
+ * @param M Mesh with every element inserted
+ * @param permutation Output, permutation[old index] = new index
+ */
+void sloan_ordering(Mesh *M, int *permutation)
+{
+    MeshGraph *G = M->get_graph();
+    int num_nodes = G->get_num_nodes();
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+
+    int *status = (int *)malloc(sizeof(int) * num_nodes);
+    int *distance = (int *)malloc(sizeof(int) * num_nodes);
+    int *queue = (int *)malloc(sizeof(int) * num_nodes);
+    IndexedMinHeap candidates(num_nodes);
+
+    for (int i = 0; i < num_nodes; i++)
+    {
+        status[i] = INACTIVE;
+        distance[i] = -1;
+        permutation[i] = -1;
+    }
+
+    int next_number = 0;
+
+    for (int seed = 0; seed < num_nodes; seed++)
+    {
+        if (permutation[seed] != -1)
+            continue;
+
+        // lowest degree node of the component, a good first guess for the start
+        int root = seed;
+        int reached = sloan_bfs(G, seed, distance, queue);
+        for (int q = 0; q < reached; q++)
+            if (G->count_neighbours_of(queue[q]) < G->count_neighbours_of(root))
+                root = queue[q];
+        clear_bfs_levels(distance, queue, reached);
+
+        int start = root, end = root;
+        sloan_pseudo_peripheral_nodes(G, root, &start, &end, distance, queue);
+
+        // Distances to the end node, queue keeps the component for the reset below
+        reached = sloan_bfs(G, end, distance, queue);
+
+        candidates.insert(start, -(SLOAN_W1 * distance[start] - SLOAN_W2 * (G->count_neighbours_of(start) + 1)));
+        status[start] = PREACTIVE;
+
+        while (!candidates.is_empty())
+        {
+            int i = candidates.extract_min();
+
+            // i was only preactive: its neighbours get closer to the front
+            if (status[i] == PREACTIVE)
+                for (int p = offset[i]; p < offset[i + 1]; p++)
+                    raise_sloan_priority(G, &candidates, status, distance, index[p]);
+
+            permutation[i] = next_number++;
+            status[i] = POSTACTIVE;
+
+            for (int p = offset[i]; p < offset[i + 1]; p++)
+            {
+                int j = index[p];
+                if (status[j] != PREACTIVE)
+                    continue;
+
+                status[j] = ACTIVE;
+                candidates.decrease_key(j, candidates.get_key(j) - SLOAN_W2);
+
+                for (int r = offset[j]; r < offset[j + 1]; r++)
+                    if (status[index[r]] != POSTACTIVE)
+                        raise_sloan_priority(G, &candidates, status, distance, index[r]);
+            }
+        }
+
+        clear_bfs_levels(distance, queue, reached);
+    }
+
+    free(status);
+    free(distance);
+    free(queue);
+}
+
+/**
+ * @brief Size of the lower profile of K for a numbering
+ *
+ * Sum over rows of (row - first column with a nonzero), diagonal excluded.
+ *
+ * @param permutation permutation[old index] = new index, NULL for the GiD numbering
+ */
+long long profile_size(MeshGraph *G, int *permutation)
+{
+    int num_nodes = G->get_num_nodes();
+    int *offset = G->get_node_offsets();
+    int *index = G->get_node_indices();
+
+    long long profile = 0;
+    for (int i = 0; i < num_nodes; i++)
+    {
+        int row = permutation == NULL ? i : permutation[i];
+        int first = row;
+        for (int p = offset[i]; p < offset[i + 1]; p++)
+        {
+            int col = permutation == NULL ? index[p] : permutation[index[p]];
+            if (col < first)
+                first = col;
+        }
+        profile += row - first;
+    }
+    return profile;
+}
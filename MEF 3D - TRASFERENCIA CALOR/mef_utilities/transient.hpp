@@ -0,0 +1,318 @@
+/**
+ * @file mef_utilities/transient.hpp
+ *
+ * @brief Transient heat conduction with the theta method
+ *
+ * With C the heat capacity (mass) matrix and K, b the ones of the steady
+ * problem:
+ *
+ *  C dT/dt + K T = b
+ *
+ * and between t and t + dt the theta method gives
+ *
+ *  (C/dt + theta*K) T(t + dt) = (C/dt - (1 - theta)*K) T(t) + b
+ *
+ *  - theta = 1: backward Euler, first order, never oscillates
+ *  - theta = 1/2: Crank-Nicolson, second order, may oscillate for large dt
+ *  - theta = 0: forward Euler, stable only for small dt
+ *
+ * C of a linear tetrahedron of volume V, with rho*c the volumetric heat
+ * capacity, is
+ *
+ *  - consistent: (rho*c*V/20) [2 1 1 1; 1 2 1 1; 1 1 2 1; 1 1 1 2]
+ *  - lumped: (rho*c*V/4) I, the row sums of the consistent one
+ *
+ * dt is fixed, so the left matrix is assembled once in profile storage,
+ * with the Sloan ordering as in solve_profile(), and factorized once. Each
+ * step is then the right hand side and a forward and backward substitution.
+ * The product with T(t) is done element by element with the local K and
+ * the element volumes, so the right matrix is never assembled.
+ *
+ * Dirichlet values do not change in time: their columns move once to the
+ * constant part of the right hand side, the rest of it is the product.
+ *
+ * With --explicit the lumped C is inverted directly instead, see
+ * explicit_transient.hpp.
+ */
+
+enum mass_matrix
+{
+    MASS_CONSISTENT,
+    MASS_LUMPED,
+    NUM_MASS_MATRICES
+};
+
+static const char *mass_names[NUM_MASS_MATRICES] = {"consistent", "lumped"};
+
+enum explicit_scheme
+{
+    EXPLICIT_NONE, // theta method
+    EXPLICIT_EULER,
+    EXPLICIT_RK2,
+    NUM_EXPLICIT_SCHEMES
+};
+
+static const char *explicit_names[NUM_EXPLICIT_SCHEMES] = {"none", "euler", "rk2"};
+
+/**
+ * @brief Options of a transient run (--transient, --theta, --mass,
+ * --capacity, --initial, --explicit, --output-every)
+ */
+struct TransientSettings
+{
+    double time_step;
+    int steps;
+    double theta;
+    int mass;       // mass_matrix
+    float capacity; // rho*c
+    float initial;  // temperature at t = 0 of the nodes without Dirichlet condition
+    int scheme;     // explicit_scheme
+    int output_every;
+};
+
+/**
+ * @brief Mass matrix of a name of mass_names, -1 if there is none
+ */
+int parse_mass(string name)
+{
+    for (int m = 0; m < NUM_MASS_MATRICES; m++)
+        if (name == mass_names[m])
+            return m;
+    return -1;
+}
+
+/**
+ * @brief Explicit scheme of a name of explicit_names, -1 if there is none
+ */
+int parse_explicit(string name)
+{
+    for (int s = EXPLICIT_EULER; s < NUM_EXPLICIT_SCHEMES; s++)
+        if (name == explicit_names[s])
+            return s;
+    return -1;
+}
+
+/**
+ * @brief True if the result of step is written: t = 0, every output_every
+ * steps and the last one
+ */
+inline bool is_output_step(TransientSettings *settings, int step)
+{
+    return step % settings->output_every == 0 || step == settings->steps;
+}
+
+/**
+ * @brief theta of backward_euler, crank_nicolson or a number from 0 to 1,
+ * -1 if invalid
+ */
+double parse_theta(string text)
+{
+    if (text == "backward_euler")
+        return 1;
+    if (text == "crank_nicolson")
+        return 0.5;
+
+    char *end;
+    double theta = strtod(text.c_str(), &end);
+    return end == text.c_str() || *end != '\0' || theta < 0 || theta > 1 ? -1 : theta;
+}
+
+/**
+ * @brief (rho*c*V) of every element, the scale of its local C
+ */
+void calculate_element_capacities(Mesh *M, float capacity, float *capacities)
+{
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    float *x = M->get_x_coordinates(), *y = M->get_y_coordinates(), *z = M->get_z_coordinates();
+    int *connectivity = M->get_connectivity();
+
+    for (int e = 0; e < num_elements; e++)
+    {
+        TetrahedronGeometry g;
+        tetrahedron_geometry(x, y, z, &connectivity[4 * e], &g);
+        capacities[e] = capacity * g.volume;
+    }
+}
+
+/**
+ * @brief Entry (r, c) of the local C of an element with scale rho*c*V
+ */
+inline float local_capacity(int mass, float scale, int r, int c)
+{
+    if (mass == MASS_LUMPED)
+        return r == c ? scale / 4 : 0;
+    return r == c ? scale / 10 : scale / 20;
+}
+
+/**
+ * @brief Allocates A with the profile of K and assembles
+ * A = C/dt + theta*K and b
+ */
+void assembly_transient(SkylineMatrix *A, Vector *b, Matrix *Ks, Vector *bs, float *capacities,
+                        TransientSettings *settings, Mesh *M, int *permutation)
+{
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int *connectivity = M->get_connectivity();
+    float theta = settings->theta, inverse_dt = 1 / settings->time_step;
+
+    allocate_profile(A, M, permutation);
+    b->init();
+    ProgressBar progress("Assembly", num_elements);
+    PerfRegion region("assembly", 52.0 * num_elements);
+
+    for (int e = 0; e < num_elements; e++)
+    {
+        progress.update(e);
+        for (int r = 0; r < 4; r++)
+        {
+            int row = permutation[connectivity[4 * e + r]];
+            for (int c = 0; c < 4; c++)
+                A->add(local_capacity(settings->mass, capacities[e], r, c) * inverse_dt + theta * Ks[e].get(r, c),
+                       row, permutation[connectivity[4 * e + c]]);
+            b->add(bs[e].get(r), row);
+        }
+    }
+    progress.finish();
+}
+
+/**
+ * @brief rhs += (C/dt - (1 - theta)*K) T, element by element
+ *
+ * T and rhs are in the numbering of the permutation.
+ */
+void add_explicit_product(Vector *rhs, Vector *T, Matrix *Ks, float *capacities, TransientSettings *settings,
+                          Mesh *M, int *permutation)
+{
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int *connectivity = M->get_connectivity();
+    float explicit_part = 1 - settings->theta, inverse_dt = 1 / settings->time_step;
+    PerfRegion region("explicit_product", 64.0 * num_elements);
+
+    for (int e = 0; e < num_elements; e++)
+    {
+        int rows[4];
+        float local_T[4];
+        for (int r = 0; r < 4; r++)
+        {
+            rows[r] = permutation[connectivity[4 * e + r]];
+            local_T[r] = T->get(rows[r]);
+        }
+
+        for (int r = 0; r < 4; r++)
+        {
+            float value = 0;
+            for (int c = 0; c < 4; c++)
+                value += (local_capacity(settings->mass, capacities[e], r, c) * inverse_dt -
+                          explicit_part * Ks[e].get(r, c)) * local_T[c];
+            rhs->add(value, rows[r]);
+        }
+    }
+}
+
+/**
+ * @brief Time integration from T = settings->initial at t = 0, the output
+ * steps written to filename.post.res as they are computed
+ *
+ * @param T_full Output, value at the last step of node with ID i at position i - 1
+ */
+void solve_transient(Mesh *M, Matrix *local_Ks, Vector *local_bs, TransientSettings *settings, string filename,
+                     RunReport *report, Vector *T_full, SolverRecord *solver)
+{
+    int num_nodes = M->get_quantity(NUM_NODES);
+    int num_elements = M->get_quantity(NUM_ELEMENTS);
+    int num_dirichlet = M->get_quantity(NUM_DIRICHLET);
+    int *permutation = (int *)malloc(sizeof(int) * num_nodes);
+    float *capacities = (float *)malloc(sizeof(float) * num_elements);
+
+    report->phase("ordering");
+    log_message(LOG_SUMMARY, "Renumbering nodes (Sloan)...\n");
+    sloan_ordering(M, permutation);
+
+    SkylineMatrix A;
+    Vector b(num_nodes);
+
+    report->phase("assembly");
+    log_message(LOG_SUMMARY, "Performing Assembly...\n");
+    calculate_element_capacities(M, settings->capacity, capacities);
+    assembly_transient(&A, &b, local_Ks, local_bs, capacities, settings, M, permutation);
+
+    report->phase("neumann");
+    log_message(LOG_SUMMARY, "Applying Neumann Boundary Conditions...\n");
+    apply_neumann_boundary_conditions(&b, M, permutation);
+
+    /**
+     * @brief Apply Dirichlet
+     *
+     * As in solve_profile(), but b becomes the constant part of every right
+     * hand side, and the rows of the fixed nodes keep their values.
+     **/
+    report->phase("dirichlet");
+    log_message(LOG_SUMMARY, "Applying Dirichlet Boundary Conditions...\n");
+    apply_dirichlet_boundary_conditions(&A, &b, M, permutation);
+
+    int *fixed = (int *)malloc(sizeof(int) * (num_dirichlet > 0 ? num_dirichlet : 1));
+    for (int c = 0; c < num_dirichlet; c++)
+        fixed[c] = permutation[M->get_dirichlet_condition(c)->get_node()->get_ID() - 1];
+
+    report->phase("factorization");
+    log_message(LOG_SUMMARY, "Factorizing C/dt + theta*K...\n");
+    {
+        PerfRegion region("skyline_factorization", A.factorization_flops());
+        A.factorize();
+    }
+
+    /**
+     * @brief Time steps
+     *
+     * Every step is one right hand side and one solve with the factorization
+     * above. Fixed nodes start, and stay, at their condition value.
+     **/
+    report->phase("time_steps");
+    log_message(LOG_SUMMARY, "Integrating " + to_string(settings->steps) + " time steps of " +
+                                 to_string(settings->time_step) + " (theta " + to_string(settings->theta) + ", " +
+                                 mass_names[settings->mass] + " mass)...\n");
+    Vector T(num_nodes), rhs(num_nodes);
+    for (int i = 0; i < num_nodes; i++)
+        T.set(settings->initial, i);
+    for (int c = 0; c < num_dirichlet; c++)
+        T.set(b.get(fixed[c]), fixed[c]);
+
+    PostResStream output(filename);
+    for (int i = 0; i < num_nodes; i++)
+        T_full->set(T.get(permutation[i]), i);
+    output.write_step(T_full, M, 0);
+
+    ProgressBar progress("Time steps", settings->steps);
+    for (int step = 1; step <= settings->steps; step++)
+    {
+        progress.update(step - 1);
+        for (int i = 0; i < num_nodes; i++)
+            rhs.set(b.get(i), i);
+        add_explicit_product(&rhs, &T, local_Ks, capacities, settings, M, permutation);
+        for (int c = 0; c < num_dirichlet; c++)
+            rhs.set(b.get(fixed[c]), fixed[c]);
+
+        {
+            PerfRegion region("skyline_solve", 4.0 * A.get_stored_values());
+            A.solve(&rhs, &T);
+        }
+
+        if (is_output_step(settings, step))
+        {
+            for (int i = 0; i < num_nodes; i++)
+                T_full->set(T.get(permutation[i]), i);
+            output.write_step(T_full, M, step * settings->time_step);
+        }
+    }
+    progress.finish();
+    output.close();
+    report->end_phase();
+
+    free(permutation);
+    free(capacities);
+    free(fixed);
+
+    solver->unknowns = num_nodes;
+    solver->nonzeros = assembled_nonzeros(M);
+    log_message(LOG_DEBUG, "\tProfile of C/dt + theta*K: " + to_string(A.get_stored_values()) + " stored values");
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "geometry/mesh_generator.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "gid/input_output.hpp"
+
+double elapsed_ms(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Structured tetrahedral mesh generator
+ *
+ * Writes filename.dat with a box of cells_x * cells_y * cells_z cubes, see
+ * geometry/mesh_generator.hpp. Options:
+ *
+ *  - --split5 (default) or --split6: tetrahedra per cube
+ *  - --size lx ly lz: box lengths, by default one unit per cube
+ *  - --dirichlet faces, --neumann faces: comma separated list of xmin, xmax,
+ *    ymin, ymax, zmin, zmax, or all / none (default zmin and zmax)
+ *  - --data k Q T_bar T_hat: problem data (default those of input.dat)
+ *  - --meshbin: also writes filename.meshbin, so the first run of mef maps
+ *    the mesh instead of parsing the text
+ *
+ * @example mesh_generator.exe cubo_100 100 100 100 --split6 --meshbin
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        if (argc < 5)
+        {
+            cout << "Incorrect use of the program, it must be: mesh_generator filename cells_x cells_y cells_z "
+                    "[--split5 | --split6] [--size lx ly lz] [--dirichlet faces] [--neumann faces] "
+                    "[--data k Q T_bar T_hat] [--meshbin]\n";
+            exit(EXIT_FAILURE);
+        }
+
+        string filename(argv[1]);
+        BoxMeshSpec spec = box_mesh_spec(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+        bool meshbin = false;
+
+        for (int a = 5; a < argc; a++)
+        {
+            string option(argv[a]);
+            int values = option == "--size" ? 3 : option == "--data" ? 4 : option == "--dirichlet" || option == "--neumann" ? 1 : 0;
+            if (a + values >= argc)
+                throw runtime_error("Missing values after " + option);
+
+            if (option == "--split5")
+                spec.split = SPLIT_5_TETRAHEDRA;
+            else if (option == "--split6")
+                spec.split = SPLIT_6_TETRAHEDRA;
+            else if (option == "--size")
+                for (int d = 0; d < 3; d++)
+                    spec.size[d] = atof(argv[a + 1 + d]);
+            else if (option == "--dirichlet")
+                spec.dirichlet_faces = parse_box_faces(argv[a + 1]);
+            else if (option == "--neumann")
+                spec.neumann_faces = parse_box_faces(argv[a + 1]);
+            else if (option == "--data")
+            {
+                spec.k = atof(argv[a + 1]);
+                spec.Q = atof(argv[a + 2]);
+                spec.T_bar = atof(argv[a + 3]);
+                spec.T_hat = atof(argv[a + 4]);
+            }
+            else if (option == "--meshbin")
+                meshbin = true;
+            else
+                throw runtime_error("Unknown option " + option);
+            a += values;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Mesh M;
+        generate_box_mesh(&spec, &M);
+        double generate_ms = elapsed_ms(start);
+
+        start = chrono::steady_clock::now();
+        write_dat(filename, &M);
+        double write_ms = elapsed_ms(start);
+
+        cout << filename << ".dat: " << M.get_quantity(NUM_NODES) << " nodes, " << M.get_quantity(NUM_ELEMENTS)
+             << " elements, " << M.get_quantity(NUM_DIRICHLET) << " Dirichlet and " << M.get_quantity(NUM_NEUMANN)
+             << " Neumann nodes (generated in " << generate_ms << " ms, written in " << write_ms << " ms)\n";
+
+        if (meshbin)
+        {
+            start = chrono::steady_clock::now();
+            write_dat_cache(filename, &M);
+            cout << filename << ".meshbin written in " << elapsed_ms(start) << " ms\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
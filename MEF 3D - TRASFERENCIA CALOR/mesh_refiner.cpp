@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "geometry/mesh_refinement.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "gid/input_output.hpp"
+#include "gid/gid_project.hpp"
+
+double elapsed_ms(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Uniform mesh refinement
+ *
+ * Reads input.dat (or a GiD project folder), refines it levels times, each
+ * level splitting every tetrahedron in 8 (see geometry/mesh_refinement.hpp),
+ * and writes output.dat. Only two levels are in memory at once.
+ *
+ * With --meshbin it also writes output.meshbin, so the first run of mef maps
+ * the mesh instead of parsing the text.
+ *
+ * @example mesh_refiner.exe input input_r2 2
+ * @example mesh_refiner.exe "Proyectos GID/MALLA_GRANDE.gid" malla_grande_r1 1 --meshbin
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        bool meshbin = argc == 5 && string(argv[4]) == "--meshbin";
+        if ((argc != 4 && !meshbin) || atoi(argv[3]) < 0)
+        {
+            cout << "Incorrect use of the program, it must be: mesh_refiner input output levels [--meshbin]\n";
+            exit(EXIT_FAILURE);
+        }
+
+        string input(argv[1]), output(argv[2]);
+        int levels = atoi(argv[3]);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Mesh *M = new Mesh();
+        if (is_gid_project(input))
+            read_gid_project(gid_project_basename(input), M);
+        else
+            read_input(input, M);
+        cout << "Level 0: " << M->get_quantity(NUM_NODES) << " nodes, " << M->get_quantity(NUM_ELEMENTS)
+             << " elements (read in " << elapsed_ms(start) << " ms)\n";
+
+        for (int level = 1; level <= levels; level++)
+        {
+            start = chrono::steady_clock::now();
+            Mesh *fine = new Mesh();
+            refine_mesh(M, fine);
+            delete M;
+            M = fine;
+            cout << "Level " << level << ": " << M->get_quantity(NUM_NODES) << " nodes, "
+                 << M->get_quantity(NUM_ELEMENTS) << " elements, " << M->get_quantity(NUM_DIRICHLET)
+                 << " Dirichlet and " << M->get_quantity(NUM_NEUMANN) << " Neumann nodes (refined in "
+                 << elapsed_ms(start) << " ms)\n";
+        }
+
+        start = chrono::steady_clock::now();
+        write_dat(output, M);
+        cout << output << ".dat written in " << elapsed_ms(start) << " ms\n";
+
+        if (meshbin)
+        {
+            start = chrono::steady_clock::now();
+            write_dat_cache(output, M);
+            cout << output << ".meshbin written in " << elapsed_ms(start) << " ms\n";
+        }
+        delete M;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
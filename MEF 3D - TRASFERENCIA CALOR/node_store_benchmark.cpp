@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "gid/input_output.hpp"
+#include "gid/gid_project.hpp"
+
+#define REPETITIONS 7
+#define SHUFFLE_SEED 12345
+
+double elapsed_ns(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Times one storage policy on the nodes of a mesh
+ *
+ * - insert: every node in ID order, the best case of the heap, where no
+ *   insertion sifts up
+ * - insert_shuffled: every node in a fixed random order (SHUFFLE_SEED)
+ * - lookup: every node ID referenced by the elements, in element order,
+ *   the same access pattern of read_input() and assembly()
+ * - iterate: sum of the coordinates of every node through at()
+ *
+ * Each measure is the median of REPETITIONS runs, reported in ns per operation.
+ */
+template <class Storage>
+void benchmark_storage(string mesh_name, string storage_name, Node **node_list, Node **shuffled_list, int num_nodes,
+                       int *lookup_ids, int num_lookups)
+{
+    double insert[REPETITIONS], insert_shuffled[REPETITIONS], lookup[REPETITIONS], iterate[REPETITIONS];
+    float checksum = 0;
+
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        NodeStore<Storage> shuffled_store;
+        shuffled_store.init(num_nodes);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < num_nodes; i++)
+            shuffled_store.insert(shuffled_list[i]);
+        insert_shuffled[r] = elapsed_ns(start) / num_nodes;
+
+        NodeStore<Storage> store;
+        store.init(num_nodes);
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < num_nodes; i++)
+            store.insert(node_list[i]);
+        insert[r] = elapsed_ns(start) / num_nodes;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < num_lookups; i++)
+            checksum += store.find(lookup_ids[i])->get_x_coordinate();
+        lookup[r] = elapsed_ns(start) / num_lookups;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < store.size(); i++)
+        {
+            Node *node = store.at(i);
+            checksum += node->get_x_coordinate() + node->get_y_coordinate() + node->get_z_coordinate();
+        }
+        iterate[r] = elapsed_ns(start) / num_nodes;
+    }
+
+    sort(insert, insert + REPETITIONS);
+    sort(insert_shuffled, insert_shuffled + REPETITIONS);
+    sort(lookup, lookup + REPETITIONS);
+    sort(iterate, iterate + REPETITIONS);
+
+    cout << mesh_name << "," << storage_name << "," << num_nodes << "," << insert[REPETITIONS / 2] << ","
+         << insert_shuffled[REPETITIONS / 2] << "," << lookup[REPETITIONS / 2] << "," << iterate[REPETITIONS / 2] << "," << checksum << "\n";
+}
+
+/**
+ * @brief Node storage micro-benchmark
+ *
+ * Compares the NodeStore policies of geometry/node_store.hpp on real meshes,
+ * times are ns per operation. An input is a GiD project folder or a .dat
+ * (no file extension), as mef takes them.
+ *
+ * @example node_store_benchmark.exe "Proyectos GID/MALLA_PEQ.gid" "Proyectos GID/MALLA_MEDIANA.gid" "Proyectos GID/MALLA_GRANDE.gid"
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            cout << "Incorrect use of the program, it must be: node_store_benchmark input [input ...]\n";
+            exit(EXIT_FAILURE);
+        }
+
+        cout << "mesh,storage,nodes,insert_ns,insert_shuffled_ns,lookup_ns,iterate_ns,checksum\n";
+
+        for (int f = 1; f < argc; f++)
+        {
+            string filename(argv[f]);
+            Mesh M;
+            if (is_gid_project(filename))
+                read_gid_project(gid_project_basename(filename), &M);
+            else
+                read_input(filename, &M);
+
+            int num_nodes = M.get_quantity(NUM_NODES);
+            int num_elements = M.get_quantity(NUM_ELEMENTS);
+
+            Node **node_list = (Node **)malloc(sizeof(Node *) * num_nodes);
+            Node **shuffled_list = (Node **)malloc(sizeof(Node *) * num_nodes);
+            for (int i = 0; i < num_nodes; i++)
+                node_list[i] = shuffled_list[i] = M.get_node(i);
+            shuffle(shuffled_list, shuffled_list + num_nodes, mt19937(SHUFFLE_SEED));
+
+            int *lookup_ids = (int *)malloc(sizeof(int) * 4 * num_elements);
+            for (int e = 0; e < num_elements; e++)
+            {
+                Element *element = M.get_element(e);
+                lookup_ids[4 * e] = element->get_node1()->get_ID();
+                lookup_ids[4 * e + 1] = element->get_node2()->get_ID();
+                lookup_ids[4 * e + 2] = element->get_node3()->get_ID();
+                lookup_ids[4 * e + 3] = element->get_node4()->get_ID();
+            }
+
+            benchmark_storage<ArrayNodeStorage>(filename, "array", node_list, shuffled_list, num_nodes, lookup_ids,
+                                                4 * num_elements);
+            benchmark_storage<HeapNodeStorage>(filename, "heap", node_list, shuffled_list, num_nodes, lookup_ids,
+                                               4 * num_elements);
+            benchmark_storage<HashNodeStorage>(filename, "hash", node_list, shuffled_list, num_nodes, lookup_ids,
+                                               4 * num_elements);
+
+            free(node_list);
+            free(shuffled_list);
+            free(lookup_ids);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
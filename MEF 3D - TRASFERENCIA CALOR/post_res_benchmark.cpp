@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "gid/input_output.hpp"
+
+#define REPETITIONS 5
+
+double elapsed_ms(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+string read_file(string path)
+{
+    MappedFile file;
+    file.open(path);
+    return string(file.get_data(), file.get_size());
+}
+
+/**
+ * @brief The writer before the parallel one, ofstream << per value
+ */
+void write_output_stream(string filename, Vector *T, Mesh *M)
+{
+    ofstream res_file(filename + ".post.res");
+    res_file << "GiD Post Results File 1.0\n";
+    res_file << "Result \"Temperature\" \"Load Case 1\" " << 1 << " Scalar OnNodes\n";
+    res_file << "ComponentNames \"T\"\n";
+    res_file << "Values\n";
+    for (int i = 0; i < T->get_size(); i++)
+        res_file << M->get_node_ids()->to_id(i) << "     " << T->get(i) << "\n";
+    res_file << "End values\n";
+}
+
+/**
+ * @brief Reference formatter, printf("%lld     %.*g\n") per value
+ */
+void write_output_printf(string filename, Vector *T, Mesh *M, int precision)
+{
+    FILE *res_file = fopen((filename + ".post.res").c_str(), "w");
+    fprintf(res_file, "GiD Post Results File 1.0\n");
+    fprintf(res_file, "Result \"Temperature\" \"Load Case 1\" 1 Scalar OnNodes\n");
+    fprintf(res_file, "ComponentNames \"T\"\n");
+    fprintf(res_file, "Values\n");
+    for (int i = 0; i < T->get_size(); i++)
+        fprintf(res_file, "%lld     %.*g\n", M->get_node_ids()->to_id(i), precision, (double)T->get(i));
+    fprintf(res_file, "End values\n");
+    fclose(res_file);
+}
+
+/**
+ * @brief Times one formatter and checks its file against the reference
+ *
+ * @param formatter 0 = ofstream, 1 = printf reference, 2 = write_output()
+ */
+void benchmark_formatter(int formatter, string name, Vector *T, Mesh *M, int precision, string reference)
+{
+    string filename = "post_res_benchmark_" + name;
+    double times[REPETITIONS];
+
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (formatter == 0)
+            write_output_stream(filename, T, M);
+        else if (formatter == 1)
+            write_output_printf(filename, T, M, precision);
+        else
+            write_output(filename, T, M, precision);
+        times[r] = elapsed_ms(start);
+    }
+    sort(times, times + REPETITIONS);
+
+    string output = read_file(filename + ".post.res");
+    remove((filename + ".post.res").c_str());
+
+    double median = times[REPETITIONS / 2];
+    cout << T->get_size() << "," << precision << "," << name << "," << median << ","
+         << output.size() / median / 1000 << "," << (output == reference ? "yes" : "no") << "\n";
+}
+
+/**
+ * @brief Result writer benchmark
+ *
+ * Formats the same temperature field with ofstream (the previous
+ * write_output()), printf (the reference) and the parallel to_chars writer,
+ * and reports the median time of REPETITIONS runs, the throughput in MB/s and
+ * whether the file is byte identical to the reference. ofstream only takes
+ * part at precision 6, its default.
+ *
+ * @example post_res_benchmark.exe 100000 1000000 10000000 [number of nodes]
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cout << "Incorrect use of the program, it must be: post_res_benchmark num_nodes [num_nodes ...]\n";
+        exit(EXIT_FAILURE);
+    }
+
+    cout << "nodes,precision,formatter,ms,mb_per_s,identical\n";
+
+    for (int a = 1; a < argc; a++)
+    {
+        int num_nodes = atoi(argv[a]);
+
+        Mesh M;
+        M.get_node_ids()->build_identity(num_nodes);
+
+        // Temperatures with a spread of magnitudes, fixed seed
+        Vector T(num_nodes);
+        unsigned int seed = 12345;
+        for (int i = 0; i < num_nodes; i++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            T.set(300 + (seed >> 8) / 16777216.0f * 400 - (i % 97 == 0 ? 300 : 0), i);
+        }
+
+        int precisions[2] = {6, 9};
+        for (int p = 0; p < 2; p++)
+        {
+            write_output_printf("post_res_benchmark_reference", &T, &M, precisions[p]);
+            string reference = read_file("post_res_benchmark_reference.post.res");
+            remove("post_res_benchmark_reference.post.res");
+
+            if (precisions[p] == 6)
+                benchmark_formatter(0, "ofstream", &T, &M, precisions[p], reference);
+            benchmark_formatter(1, "printf", &T, &M, precisions[p], reference);
+            benchmark_formatter(2, "to_chars", &T, &M, precisions[p], reference);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "gid/post_res_compare.hpp"
+
+/**
+ * @brief Result regression check
+ *
+ * Compares a results file with a reference one (see
+ * gid/post_res_compare.hpp) and prints the errors and the worst nodes.
+ * Exits with EXIT_FAILURE when a value is NaN or infinite or the relative
+ * L2 error is above the tolerance (POST_RES_TOLERANCE by default), so it
+ * can follow a run in a script.
+ *
+ * @example post_res_compare.exe MALLA_PEQ.post.res "../RESULTADOS POSTPROCESOS/MALLA_PEQ.post.res" --tolerance 1e-5
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        bool valid = argc == 3 || (argc == 5 && string(argv[3]) == "--tolerance");
+        if (!valid)
+        {
+            cout << "Incorrect use of the program, it must be: post_res_compare result.post.res reference.post.res [--tolerance relative_l2_error]\n";
+            exit(EXIT_FAILURE);
+        }
+        double tolerance = argc == 5 ? atof(argv[4]) : POST_RES_TOLERANCE;
+
+        ResultComparison comparison = compare_post_res(argv[1], argv[2]);
+        report_comparison(&comparison);
+
+        if (!results_within(&comparison, tolerance))
+        {
+            cout << "FAILED: relative L2 error above " << tolerance << " or non finite values\n";
+            return EXIT_FAILURE;
+        }
+        cout << "OK: relative L2 error within " << tolerance << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,424 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "geometry/mesh_generator.hpp"
+#include "geometry/mesh_refinement.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "mef_utilities/mef_process.hpp"
+#include "gid/input_output.hpp"
+#include "gid/gid_project.hpp"
+#include "gid/post_res_compare.hpp"
+
+#define SCALING_WORK_DIR "scaling_runs"
+
+/**
+ * @brief Phase columns of the table: read, local_systems, assembly, bcs
+ * (neumann + dirichlet), solve and write phases of the run report
+ */
+#define NUM_PHASE_COLUMNS 6
+
+struct ScalingCase
+{
+    string name;
+    string input;     // mesh as mef takes it: .dat without extension or GiD project folder
+    string reference; // .post.res to compare with, empty if there is none
+};
+
+struct ScalingBuild
+{
+    string label;
+    string executable;
+};
+
+/**
+ * @brief Result of one run, read back from the report and the results file
+ */
+struct ScalingRun
+{
+    bool ok;
+    string solver;
+    int nodes, elements;
+    double phase_ms[NUM_PHASE_COLUMNS];
+    double total_ms;
+    double peak_rss_mb;
+    double residual;
+    double max_abs_error, max_rel_error, rel_l2_error;
+};
+
+string read_text(string path)
+{
+    MappedFile file;
+    file.open(path);
+    return string(file.get_data(), file.get_size());
+}
+
+/**
+ * @brief Number after "key": in text, starting at from; NAN if missing or null
+ */
+double json_number(const string &text, string key, size_t from = 0)
+{
+    size_t position = text.find("\"" + key + "\": ", from);
+    if (position == string::npos)
+        return NAN;
+    const char *start = text.c_str() + position + key.size() + 4;
+    char *end;
+    double value = strtod(start, &end);
+    return end == start ? NAN : value; // null
+}
+
+string json_text(const string &text, string key)
+{
+    size_t position = text.find("\"" + key + "\": \"");
+    if (position == string::npos)
+        return "";
+    position += key.size() + 5;
+    return text.substr(position, text.find('"', position) - position);
+}
+
+/**
+ * @brief Milliseconds of a phase of the run report, 0 if it did not run
+ */
+double phase_ms(const string &report, string phase)
+{
+    size_t position = report.find("{\"name\": \"" + phase + "\"");
+    return position == string::npos ? 0 : json_number(report, "ms", position);
+}
+
+/**
+ * @brief Copies a case into the work folder, so the results and caches mef
+ * writes next to its input never touch the original files
+ */
+string prepare_case(ScalingCase *c)
+{
+    namespace fs = std::filesystem;
+    fs::create_directories(SCALING_WORK_DIR);
+    if (is_gid_project(c->input))
+    {
+        string basename = gid_project_basename(c->input);
+        string name = basename.substr(basename.find_last_of("/\\") + 1);
+        fs::path folder = fs::path(SCALING_WORK_DIR) / (name + ".gid");
+        fs::create_directories(folder);
+        const char *extensions[5] = {".msh", ".prb", ".cnd", ".conditions", ".dat"};
+        for (int e = 0; e < 5; e++)
+            if (fs::exists(basename + extensions[e]))
+                fs::copy_file(basename + extensions[e], folder / (name + extensions[e]), fs::copy_options::overwrite_existing);
+        return folder.string();
+    }
+
+    fs::path copy = fs::path(SCALING_WORK_DIR) / c->name;
+    fs::copy_file(c->input + ".dat", copy.string() + ".dat", fs::copy_options::overwrite_existing);
+    return copy.string();
+}
+
+/**
+ * @brief Runs a build on a prepared case with the given solver and threads
+ */
+ScalingRun run_case(ScalingBuild *build, string input, string solver, int threads, ScalingCase *c)
+{
+    string basename = is_gid_project(input) ? gid_project_basename(input) : input;
+    string report_path = basename + ".report.json";
+    remove(report_path.c_str());
+    remove((basename + ".post.res").c_str());
+
+    string thread_count = to_string(threads);
+#ifdef _WIN32
+    _putenv_s("OMP_NUM_THREADS", thread_count.c_str());
+    // cmd.exe strips the outer quotes of the whole line
+    string command = "\"\"" + build->executable + "\" \"" + input + "\" --quiet --report --solver " + solver + "\"";
+#else
+    setenv("OMP_NUM_THREADS", thread_count.c_str(), 1);
+    string command = "\"" + build->executable + "\" \"" + input + "\" --quiet --report --solver " + solver;
+#endif
+    int status = system(command.c_str());
+
+    ScalingRun run;
+    run.ok = status == 0 && filesystem::exists(report_path);
+    if (!run.ok)
+        return run;
+
+    string report = read_text(report_path);
+    run.solver = json_text(report, "method");
+    run.nodes = (int)json_number(report, "nodes");
+    run.elements = (int)json_number(report, "elements");
+    run.phase_ms[0] = phase_ms(report, "read");
+    run.phase_ms[1] = phase_ms(report, "local_systems");
+    run.phase_ms[2] = phase_ms(report, "assembly");
+    run.phase_ms[3] = phase_ms(report, "neumann") + phase_ms(report, "dirichlet");
+    run.phase_ms[4] = phase_ms(report, "solve");
+    run.phase_ms[5] = phase_ms(report, "write");
+    run.total_ms = json_number(report, "total_ms");
+    run.peak_rss_mb = json_number(report, "peak_rss_bytes", report.find("\"total_ms\"")) / (1024.0 * 1024.0);
+    run.residual = json_number(report, "residual");
+
+    run.max_abs_error = run.max_rel_error = run.rel_l2_error = NAN;
+    if (!c->reference.empty())
+    {
+        ResultComparison comparison = compare_post_res(basename + ".post.res", c->reference);
+        run.max_abs_error = comparison.max_abs_error;
+        run.max_rel_error = comparison.max_rel_error;
+        run.rel_l2_error = comparison.rel_l2_error;
+    }
+    return run;
+}
+
+double median(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/**
+ * @brief One row of the table: medians of the repetitions, largest peak
+ * memory, errors of the last repetition (the solution does not change)
+ */
+void print_row(ScalingCase *c, ScalingBuild *build, string solver, int threads, vector<ScalingRun> &runs)
+{
+    cout << c->name << "," << build->label << ",";
+    if (runs.empty() || !runs.back().ok)
+    {
+        cout << solver << " failed," << threads << ",,,,,,,,,,,,,,\n";
+        return;
+    }
+
+    ScalingRun &last = runs.back();
+    cout << last.solver << "," << threads << "," << last.nodes << "," << last.elements;
+    for (int p = 0; p < NUM_PHASE_COLUMNS; p++)
+    {
+        vector<double> samples;
+        for (size_t r = 0; r < runs.size(); r++)
+            samples.push_back(runs[r].phase_ms[p]);
+        cout << "," << median(samples);
+    }
+    vector<double> totals;
+    double peak = 0;
+    for (size_t r = 0; r < runs.size(); r++)
+    {
+        totals.push_back(runs[r].total_ms);
+        peak = max(peak, runs[r].peak_rss_mb);
+    }
+    cout << "," << median(totals) << "," << peak << "," << last.residual << ",";
+    if (!c->reference.empty())
+        cout << last.max_abs_error << "," << last.max_rel_error << "," << last.rel_l2_error;
+    else
+        cout << ",,";
+    cout << "\n";
+}
+
+/**
+ * @brief Writes a generated box or a refined mesh into the work folder
+ */
+string generate_case(ScalingCase *c, int box_cells, string refine_input, int levels)
+{
+    filesystem::create_directories(SCALING_WORK_DIR);
+    string path = string(SCALING_WORK_DIR) + "/" + c->name;
+    Mesh *M = new Mesh();
+    if (box_cells > 0)
+    {
+        BoxMeshSpec spec = box_mesh_spec(box_cells, box_cells, box_cells);
+        generate_box_mesh(&spec, M);
+    }
+    else
+    {
+        if (is_gid_project(refine_input))
+            read_gid_project(gid_project_basename(refine_input), M);
+        else
+            read_input(refine_input, M);
+        for (int level = 0; level < levels; level++)
+        {
+            Mesh *fine = new Mesh();
+            refine_mesh(M, fine);
+            delete M;
+            M = fine;
+        }
+    }
+    write_dat(path, M);
+    delete M;
+    return path;
+}
+
+vector<int> parse_list(string list)
+{
+    vector<int> values;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == string::npos)
+            end = list.size();
+        values.push_back(atoi(list.substr(start, end - start).c_str()));
+        start = end + 1;
+    }
+    return values;
+}
+
+/**
+ * @brief End to end scaling benchmark
+ *
+ * Runs every build (a mef executable, e.g. compiled with another
+ * NODE_STORAGE layout) on every mesh with every solver and thread count,
+ * using --report, and prints one CSV row per combination:
+ *
+ *   mesh,build,solver,threads,nodes,elements,read_ms,local_systems_ms,
+ *   assembly_ms,bcs_ms,solve_ms,write_ms,total_ms,peak_rss_mb,residual,
+ *   max_abs_error,max_rel_error,rel_l2_error
+ *
+ * Times are the median of the repetitions. Errors are against the stored
+ * results of the mesh (gid/post_res_compare.hpp), empty for generated meshes. Rows only depend on the
+ * options, so tables of two builds or two commits can be diffed directly.
+ *
+ * Meshes are copied to scaling_runs/ first. By default they are the three
+ * GiD projects with the results of RESULTADOS POSTPROCESOS. Options:
+ *
+ *  - --build label=executable: repeatable, default mef=main.exe
+ *  - --solver skyline,cholesky: passed to mef as --solver, default skyline
+ *  - --threads 1,2,4: default 1 and all the cores
+ *  - --repeat r: runs of every combination, default 1
+ *  - --mesh name=input[=reference.post.res]: repeatable, replaces the defaults
+ *  - --box n: adds a generated box of n^3 cubes (geometry/mesh_generator.hpp)
+ *  - --refine name=input=levels: adds a refined mesh (geometry/mesh_refinement.hpp)
+ *
+ * The first run of a .dat also writes its .meshbin, later runs map it.
+ *
+ * @example scaling_benchmark.exe --build array=mef_array.exe --build heap=mef_heap.exe --threads 1,4 > scaling.csv
+ * @example scaling_benchmark.exe --solver skyline,cholesky,cholesky_inverse > solvers.csv
+ */
+int main(int argc, char **argv)
+{
+    try
+    {
+        vector<ScalingBuild> builds;
+        vector<ScalingCase> cases;
+        vector<string> solvers;
+        vector<int> thread_counts;
+        int repetitions = 1;
+        bool default_meshes = true;
+
+        for (int a = 1; a < argc; a++)
+        {
+            string option(argv[a]);
+            if (a + 1 >= argc)
+                throw runtime_error("Missing value after " + option);
+            string value(argv[++a]);
+            size_t equal = value.find('=');
+
+            if (option == "--build" && equal != string::npos)
+                builds.push_back({value.substr(0, equal), value.substr(equal + 1)});
+            else if (option == "--solver")
+            {
+                solvers.clear();
+                for (size_t start = 0; start <= value.size();)
+                {
+                    size_t end = min(value.find(',', start), value.size());
+                    string name = value.substr(start, end - start);
+                    if (parse_solver(name) == -1)
+                        throw runtime_error("Unknown solver " + name);
+                    solvers.push_back(name);
+                    start = end + 1;
+                }
+            }
+            else if (option == "--threads")
+                thread_counts = parse_list(value);
+            else if (option == "--repeat")
+                repetitions = max(1, atoi(value.c_str()));
+            else if (option == "--mesh" && equal != string::npos)
+            {
+                size_t second = value.find('=', equal + 1);
+                string input = value.substr(equal + 1, second == string::npos ? string::npos : second - equal - 1);
+                string reference = second == string::npos ? "" : value.substr(second + 1);
+                cases.push_back({value.substr(0, equal), input, reference});
+                default_meshes = false;
+            }
+            else if (option == "--box")
+            {
+                ScalingCase c = {"box_" + value, "", ""};
+                c.input = generate_case(&c, atoi(value.c_str()), "", 0);
+                cases.push_back(c);
+            }
+            else if (option == "--refine" && equal != string::npos)
+            {
+                size_t second = value.rfind('=');
+                ScalingCase c = {value.substr(0, equal), "", ""};
+                c.input = generate_case(&c, 0, value.substr(equal + 1, second - equal - 1), atoi(value.c_str() + second + 1));
+                cases.push_back(c);
+            }
+            else
+                throw runtime_error("Unknown option " + option + " " + value);
+        }
+
+        if (builds.empty())
+#ifdef _WIN32
+            builds.push_back({"mef", "main.exe"});
+#else
+            builds.push_back({"mef", "./main"});
+#endif
+        if (solvers.empty())
+            solvers.push_back("skyline");
+        if (thread_counts.empty())
+        {
+            thread_counts.push_back(1);
+            int cores = (int)thread::hardware_concurrency();
+            if (cores > 1)
+                thread_counts.push_back(cores);
+        }
+        if (default_meshes)
+        {
+            const char *projects[3] = {"MALLA_PEQ", "MALLA_MEDIANA", "MALLA_GRANDE"};
+            vector<ScalingCase> stored;
+            for (int p = 0; p < 3; p++)
+                stored.push_back({projects[p], string("../Proyectos GID/") + projects[p] + ".gid",
+                                  string("../RESULTADOS POSTPROCESOS/") + projects[p] + ".post.res"});
+            cases.insert(cases.begin(), stored.begin(), stored.end());
+        }
+
+        cout << "mesh,build,solver,threads,nodes,elements,read_ms,local_systems_ms,assembly_ms,bcs_ms,"
+                "solve_ms,write_ms,total_ms,peak_rss_mb,residual,max_abs_error,max_rel_error,rel_l2_error\n";
+        for (size_t c = 0; c < cases.size(); c++)
+        {
+            string input = cases[c].reference.empty() && cases[c].input.rfind(SCALING_WORK_DIR, 0) == 0
+                               ? cases[c].input
+                               : prepare_case(&cases[c]);
+            for (size_t b = 0; b < builds.size(); b++)
+                for (size_t s = 0; s < solvers.size(); s++)
+                    for (size_t t = 0; t < thread_counts.size(); t++)
+                    {
+                        cerr << cases[c].name << " / " << builds[b].label << " / " << solvers[s] << " / "
+                             << thread_counts[t] << " threads\n";
+                        vector<ScalingRun> runs;
+                        try
+                        {
+                            for (int r = 0; r < repetitions; r++)
+                            {
+                                runs.push_back(run_case(&builds[b], input, solvers[s], thread_counts[t], &cases[c]));
+                                if (!runs.back().ok)
+                                    break;
+                            }
+                        }
+                        catch (const std::exception &e)
+                        {
+                            cerr << e.what() << '\n';
+                            runs.clear();
+                        }
+                        print_row(&cases[c], &builds[b], solvers[s], thread_counts[t], runs);
+                        cout.flush();
+                    }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+using namespace std;
+
+#include "geometry/mesh.hpp"
+#include "math_utilities/matrix_operations.hpp"
+#include "mef_utilities/mef_process.hpp"
+#include "mef_utilities/sloan.hpp"
+#include "gid/input_output.hpp"
+#include "gid/gid_project.hpp"
+
+double elapsed_ms(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+/**
+ * @brief Assembles and factorizes K with the given numbering
+ *
+ * @return factorization time in ms
+ */
+double factorization_time(Matrix *local_Ks, Vector *local_bs, int num_elements, Mesh *M, int *permutation, long long *stored)
+{
+    SkylineMatrix K;
+    Vector b(M->get_quantity(NUM_NODES));
+
+    assembly(&K, &b, local_Ks, local_bs, num_elements, M, permutation);
+    apply_dirichlet_boundary_conditions(&K, &b, M, permutation);
+    *stored = K.get_stored_values();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    K.factorize();
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Profile reduction benchmark
+ *
+ * For every input mesh compares the GiD numbering against the Sloan ordering:
+ * size of the profile of K, time to compute the ordering and time to
+ * factorize K with the skyline solver.
+ *
+ * An input is a GiD project folder, read with its .msh, .prb and
+ * .conditions files, or a .dat (no file extension), as mef takes them.
+ *
+ * @example sloan_benchmark.exe "Proyectos GID/MALLA_PEQ.gid" "Proyectos GID/MALLA_MEDIANA.gid" "Proyectos GID/MALLA_GRANDE.gid"
+ * @example sloan_benchmark.exe box_r2 [no file extension, e.g. written by mesh_generator]
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cout << "Incorrect use of the program, it must be: sloan_benchmark input [input ...]\n";
+        exit(EXIT_FAILURE);
+    }
+
+    cout << "mesh,nodes,elements,numbering,profile,stored_values,ordering_ms,factorization_ms\n";
+
+    for (int f = 1; f < argc; f++)
+    {
+        string filename(argv[f]);
+        Mesh M;
+        if (is_gid_project(filename))
+            read_gid_project(gid_project_basename(filename), &M);
+        else
+            read_input(filename, &M);
+
+        int num_nodes = M.get_quantity(NUM_NODES);
+        int num_elements = M.get_quantity(NUM_ELEMENTS);
+
+        Matrix *local_Ks = new Matrix[num_elements];
+        Vector *local_bs = new Vector[num_elements];
+        for (int e = 0; e < num_elements; e++)
+        {
+            create_local_K(&local_Ks[e], e, &M);
+            create_local_b(&local_bs[e], e, &M);
+        }
+
+        MeshGraph *G = M.get_graph();
+
+        // GiD numbering, the identity permutation
+        int *identity = (int *)malloc(sizeof(int) * num_nodes);
+        for (int i = 0; i < num_nodes; i++)
+            identity[i] = i;
+
+        long long stored;
+        double gid_ms = factorization_time(local_Ks, local_bs, num_elements, &M, identity, &stored);
+        cout << filename << "," << num_nodes << "," << num_elements << ",gid," << profile_size(G, NULL) << ","
+             << stored << ",0," << gid_ms << "\n";
+
+        int *permutation = (int *)malloc(sizeof(int) * num_nodes);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        sloan_ordering(&M, permutation);
+        double ordering_ms = elapsed_ms(start);
+
+        double sloan_ms = factorization_time(local_Ks, local_bs, num_elements, &M, permutation, &stored);
+        cout << filename << "," << num_nodes << "," << num_elements << ",sloan," << profile_size(G, permutation) << ","
+             << stored << "," << ordering_ms << "," << sloan_ms << "\n";
+
+        free(identity);
+        free(permutation);
+        delete[] local_Ks;
+        delete[] local_bs;
+    }
+
+    return 0;
+}
@@ -1,176 +1,18 @@
-#include <iostream>
-#include <cstdlib>
+// Nodes stored in the min heap of geometry/heap.hpp
+#define NODE_STORAGE HeapNodeStorage
 
-using namespace std;
+#include "../MEF 3D - TRASFERENCIA CALOR/mef_core.hpp"
 
-#include "geometry/mesh.hpp"
-#include "math_utilities/matrix_operations.hpp"
-#include "mef_utilities/mef_process.hpp"
-#include "gid/input_output.hpp"
 /*
- * @brief MEF 3D
+ * @brief MEF 3D - Heat transfer with the nodes in a min heap
  *
- * Implementation for the Finite Element Method for a 3D mesh using data
- * from GID Mesh problemType generation
- *
- * @param argc number of params passed at execution
- * @param argv pointer to char chain witch represents every value passed at execution
+ * K is stored by its profile after the Sloan ordering, driven by the
+ * indexed min heap (--solver skyline by default). Same core and options as
+ * the heat transfer program, see "MEF 3D - TRASFERENCIA CALOR/mef_core.hpp"
  *
+ * @example g++ -O2 -fopenmp main.cpp -o main.exe
  */
 int main(int argc, char **argv)
 {
-
-    try
-    {
-
-        /*
-         * @example Correct usage mef.exe input_file [no file extension]
-         */
-        if (argc != 2)
-        {
-            cout << "Incorrect use of the program, it must be: mef filename\n";
-            exit(EXIT_FAILURE);
-        }
-
-        /*
-        Mesh representation declarations
-        */
-        Mesh M;
-
-        cout << "Reading geometry and mesh data...\n\n";
-
-        /*
-         Using string constructor from char* to string
-        */
-        string filename(argv[1]);
-
-        /*
-            Read of .dat file saving data in Mesh M
-        */
-        read_input(filename, &M);
-
-        M.report();
-
-        /**
-         *  @name Global / Acumulative values for FEM calculations
-         */
-        ///@{
-        int num_nodes = M.get_quantity(NUM_NODES); //
-
-        int num_elements = M.get_quantity(NUM_ELEMENTS);
-
-        Matrix K(num_nodes, num_nodes), local_Ks[num_elements];
-
-        Vector b(num_nodes), local_bs[num_elements];
-        ///@}
-
-        /**
-         * Finite element method 
-         * after solving result in a
-         * Linear equation system with the form
-         *
-         * K*X = B
-         *
-         * [a... b][x1]=[e]
-         * [.... .][x2]=[f]
-         * [c... d][x3]=[g]
-         *
-         * Where K is N*N Matrix continaing the coefficients of the unknowns of the system
-         * Where X is N*1 VECTOR continaing the unknowns of the system
-         *
-         * Where B is N*1 VECTOR containing the result of each equation
-         *
-         * This section calculates this Equation System for each element in the mesh
-         * its called a local system. each local system is saved into local_Bs and local_Ks vectors
-         *
-         * Then colects all local systems into a global system, 
-         * it´s an assembly process
-         * 
-         * see mef_process.hpp -> create_local_systems() for more details
-         */
-
-        cout << "Creating local systems...\n\n";
-        create_local_systems(local_Ks, local_bs, num_elements, &M);
-
-        
-        cout << "Performing Assembly...\n\n";
-        /**
-         * @brief Assembly all local_ks and local_bs into a GLOBAL K and GLOBAL B
-         * 
-         * - Local Matrices represent a element with 4 nodes
-         * - Global Matrices represent the solution of the entire mesh 
-         * 
-         * - Each element has 4 nodes, but this nodes are shared between several elements, so, its necesary
-         * assembly this elements, in order to relate the calculated values into a single node value in the 
-         * global matrices  
-         */
-        assembly(&K, &b, local_Ks, local_bs, num_elements, &M);
-
-        /**
-         * @brief Apply boundary condition 
-         * 
-         * In MEF there are two types of conditions:
-         * which are predefined values that serve as a starting point in the 
-         * calculation of the elements and define the behavior at the boundaries
-         * of the domain.         
-         */
-         
-        cout << "Applying Neumann Boundary Conditions...\n\n";
-
-        /**
-         * @brief Apply neumann boundary conditions
-         * 
-         * 
-         */
-        apply_neumann_boundary_conditions(&b, &M);
-
-        cout << "Applying Dirichlet Boundary Conditions...\n\n";
-
-        /**
-         * @brief Apply Dirichlet
-         * 
-         * The dirichlet conditions are values already determined for some nodes, 
-         * so we replace that unknown, and eliminate its corresponding row, and 
-         * the column in the same position, because, when replacing the variable,
-         * we must multiply by each column value, to reduce the matrix.         
-         **/
-        apply_dirichlet_boundary_conditions(&K, &b, &M);
-
-
-        cout << "Solving global system...\n\n";
-        /**
-         * @brief Solve system
-         * 
-         * Last form of global system were
-         * 
-         * K*T = B
-         * 
-         * So we must clear the matrix of unknowns T, arriving at the form: 
-         *  
-         * T = (K^-1)(B)
-         * 
-         * It is necessary to calculate the inverse matrix of K 
-         * and to multiply by the vector B
-         **/
-        Vector T(b.get_size()), T_full(num_nodes);
-        solve_system(&K, &b, &T);
-
-        /**
-         * @brief Reconstruct result 
-         * 
-         * 
-         */
-        cout << "Preparing results...\n\n";
-        merge_results_with_dirichlet(&T, &T_full, num_nodes, &M);
-
-        //WRITE [filename].post.res file
-        cout << "Writing output file...\n\n";
-        write_output(filename, &T_full);
-    }
-    catch (const std::exception &e)
-    {
-        std::cerr << e.what() << '\n';
-    }
-
-    return 0;
+    return run_mef<HeatKernel>(argc, argv, SOLVER_SKYLINE);
 }